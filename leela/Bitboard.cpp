@@ -0,0 +1,174 @@
+/*
+    This file is part of Leela Zero.
+
+    Leela Zero is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Leela Zero is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Leela Zero.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "config.h"
+#include "Bitboard.h"
+
+namespace {
+    int popcount(std::uint64_t word) {
+#ifdef _MSC_VER
+        return static_cast<int>(__popcnt64(word));
+#else
+        return __builtin_popcountll(word);
+#endif
+    }
+
+    // Set every vertex for which pred(vertex) holds.
+    template<int SIZE, class Pred>
+    BasicBitboard<SIZE> make_mask(Pred pred) {
+        auto mask = BasicBitboard<SIZE>{};
+        for (auto v = 0; v < SIZE * SIZE; v++) {
+            if (pred(v)) {
+                mask.set(v);
+            }
+        }
+        return mask;
+    }
+
+    template<int SIZE>
+    struct Masks {
+        BasicBitboard<SIZE> full = make_mask<SIZE>([](int) { return true; });
+        // Shifting by one vertex wraps around at the board edge,
+        // these drop the vertices that wrapped.
+        BasicBitboard<SIZE> not_first_column = make_mask<SIZE>([](int v) {
+            return v % SIZE != 0;
+        });
+        BasicBitboard<SIZE> not_last_column = make_mask<SIZE>([](int v) {
+            return v % SIZE != SIZE - 1;
+        });
+    };
+
+    template<int SIZE>
+    const auto s_masks = Masks<SIZE>{};
+
+    template<int SIZE>
+    const Masks<SIZE>& masks() {
+        return s_masks<SIZE>;
+    }
+}
+
+template<int SIZE>
+auto BasicBitboard<SIZE>::full() -> const Bitboard& {
+    return masks<SIZE>().full;
+}
+
+template<int SIZE>
+int BasicBitboard<SIZE>::count() const {
+    auto count = 0;
+    for (auto word : m_words) {
+        count += popcount(word);
+    }
+    return count;
+}
+
+template<int SIZE>
+bool BasicBitboard<SIZE>::none() const {
+    auto any = std::uint64_t{0};
+    for (auto word : m_words) {
+        any |= word;
+    }
+    return any == 0;
+}
+
+template<int SIZE>
+auto BasicBitboard<SIZE>::operator&(const Bitboard& rhs) const -> Bitboard {
+    auto result = Bitboard{};
+    for (auto i = 0; i < WORDS; i++) {
+        result.m_words[i] = m_words[i] & rhs.m_words[i];
+    }
+    return result;
+}
+
+template<int SIZE>
+auto BasicBitboard<SIZE>::operator|(const Bitboard& rhs) const -> Bitboard {
+    auto result = Bitboard{};
+    for (auto i = 0; i < WORDS; i++) {
+        result.m_words[i] = m_words[i] | rhs.m_words[i];
+    }
+    return result;
+}
+
+template<int SIZE>
+auto BasicBitboard<SIZE>::operator~() const -> Bitboard {
+    auto result = Bitboard{};
+    for (auto i = 0; i < WORDS; i++) {
+        result.m_words[i] = ~m_words[i] & masks<SIZE>().full.m_words[i];
+    }
+    return result;
+}
+
+template<int SIZE>
+bool BasicBitboard<SIZE>::operator==(const Bitboard& rhs) const {
+    auto diff = std::uint64_t{0};
+    for (auto i = 0; i < WORDS; i++) {
+        diff |= m_words[i] ^ rhs.m_words[i];
+    }
+    return diff == 0;
+}
+
+template<int SIZE>
+auto BasicBitboard<SIZE>::neighbours() const -> Bitboard {
+    // Shift the whole board as one number: by 1 for the horizontal
+    // neighbours and by a row for the vertical ones.
+    const auto& mask = masks<SIZE>();
+    auto result = Bitboard{};
+    for (auto i = 0; i < WORDS; i++) {
+        auto lower = (i > 0 ? m_words[i - 1] : 0);
+        auto upper = (i < WORDS - 1 ? m_words[i + 1] : 0);
+        auto right = (m_words[i] << 1) | (lower >> 63);
+        auto left = (m_words[i] >> 1) | (upper << 63);
+        auto up = (m_words[i] << BOARDSIZE) | (lower >> (64 - BOARDSIZE));
+        auto down = (m_words[i] >> BOARDSIZE) | (upper << (64 - BOARDSIZE));
+        result.m_words[i] = up | down
+                            | (right & mask.not_first_column.m_words[i])
+                            | (left & mask.not_last_column.m_words[i]);
+        result.m_words[i] &= mask.full.m_words[i];
+    }
+    return result;
+}
+
+template<int SIZE>
+auto BasicBitboard<SIZE>::dilate() const -> Bitboard {
+    return *this | neighbours();
+}
+
+template<int SIZE>
+auto BasicBitboard<SIZE>::flood_fill(Bitboard seed, const Bitboard& area)
+    -> Bitboard {
+    for (;;) {
+        auto grown = seed.dilate() & area;
+        if (grown == seed) {
+            return seed;
+        }
+        seed = grown;
+    }
+}
+
+template<int SIZE>
+auto BasicBitboard<SIZE>::to_bitset() const -> std::bitset<BOARDSQ> {
+    auto result = std::bitset<BOARDSQ>{};
+    for (auto i = WORDS - 1; i >= 0; i--) {
+        result <<= 64;
+        result |= std::bitset<BOARDSQ>{m_words[i]};
+    }
+    return result;
+}
+
+template class BasicBitboard<9>;
+template class BasicBitboard<13>;
+template class BasicBitboard<19>;
@@ -0,0 +1,124 @@
+/*
+    This file is part of Leela Zero.
+
+    Leela Zero is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Leela Zero is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Leela Zero.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef BITBOARD_H_INCLUDED
+#define BITBOARD_H_INCLUDED
+
+#include "config.h"
+
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+
+#include "size_info.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/*
+    One bit per vertex of a SIZE x SIZE board, vertex v = SIZE * y + x
+    is bit v % 64 of word v / 64. The operations work on whole words in
+    loops the compiler can vectorize. Bits past the last vertex
+    are always kept zero.
+    Instantiated for all the sizes in zero::size_info.
+*/
+template<int SIZE>
+class BasicBitboard {
+public:
+    using Bitboard = BasicBitboard;
+
+    static constexpr auto BOARDSIZE = SIZE;
+    static constexpr auto BOARDSQ = BOARDSIZE * BOARDSIZE;
+    static constexpr auto WORDS = (BOARDSQ + 63) / 64;
+
+    BasicBitboard() = default;
+
+    // All vertices of the board.
+    static const Bitboard& full();
+
+    bool test(int vertex) const {
+        return (m_words[vertex / 64] >> (vertex % 64)) & 1;
+    }
+    void set(int vertex) {
+        m_words[vertex / 64] |= std::uint64_t{1} << (vertex % 64);
+    }
+    void reset(int vertex) {
+        m_words[vertex / 64] &= ~(std::uint64_t{1} << (vertex % 64));
+    }
+    void clear() {
+        m_words.fill(0);
+    }
+
+    int count() const;
+    bool none() const;
+
+    Bitboard operator&(const Bitboard& rhs) const;
+    Bitboard operator|(const Bitboard& rhs) const;
+    // Complement within the board.
+    Bitboard operator~() const;
+    bool operator==(const Bitboard& rhs) const;
+    bool operator!=(const Bitboard& rhs) const {
+        return !(*this == rhs);
+    }
+
+    // All vertices adjacent to one in this set.
+    Bitboard neighbours() const;
+    // This set plus all vertices adjacent to it.
+    Bitboard dilate() const;
+    // Grow seed within the vertices of area until it stops changing.
+    // seed must be part of area.
+    static Bitboard flood_fill(Bitboard seed, const Bitboard& area);
+
+    std::bitset<BOARDSQ> to_bitset() const;
+
+    // Call f(vertex) for every vertex in the set, in increasing order.
+    template<class F>
+    void for_each(F f) const {
+        for (auto i = 0; i < WORDS; i++) {
+            auto word = m_words[i];
+            while (word) {
+                f(64 * i + lowest_bit(word));
+                word &= word - 1;
+            }
+        }
+    }
+
+private:
+    static int lowest_bit(std::uint64_t word) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, word);
+        return static_cast<int>(index);
+#else
+        return __builtin_ctzll(word);
+#endif
+    }
+
+    std::array<std::uint64_t, WORDS> m_words{};
+};
+
+extern template class BasicBitboard<9>;
+extern template class BasicBitboard<13>;
+extern template class BasicBitboard<19>;
+
+// The board size the engine is built for.
+using Bitboard = BasicBitboard<zero::board_size>;
+
+#endif
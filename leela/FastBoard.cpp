@@ -21,10 +21,10 @@
 #include <cassert>
 #include <array>
 #include <iostream>
-#include <queue>
 #include <sstream>
 #include <string>
 #include <cctype>
+#include <vector>
 
 #include "Utils.h"
 #include "Zobrist.h"
@@ -35,24 +35,26 @@ const int FastBoard::BIG;
 const int FastBoard::PASS;
 const int FastBoard::RESIGN;
 
-std::array<std::vector<int>, FastBoard::BOARDSQ> FastBoard::NEIGHBORS;
-std::array<std::vector<int>, FastBoard::BOARDSQ> FastBoard::DIAGS;
+std::array<FastBoard::VertexList, FastBoard::BOARDSQ> FastBoard::NEIGHBORS;
+std::array<FastBoard::VertexList, FastBoard::BOARDSQ> FastBoard::DIAGS;
 
 void FastBoard::init_board() {
+    NEIGHBORS.fill(VertexList{});
+    DIAGS.fill(VertexList{});
     for (int y=0; y<BOARDSIZE; y++) {
         for (int x=0; x<BOARDSIZE; x++) {
             auto& n = NEIGHBORS[y*BOARDSIZE + x];
             auto& d = DIAGS[y*BOARDSIZE + x];
 
-            if (y > 0) n.emplace_back((y-1)*BOARDSIZE + x);
-            if (y < BOARDSIZE-1) n.emplace_back((y+1)*BOARDSIZE + x);
-            if (x > 0) n.emplace_back(y*BOARDSIZE + x - 1);
-            if (x < BOARDSIZE-1) n.emplace_back(y*BOARDSIZE + x + 1);
+            if (y > 0) n.add((y-1)*BOARDSIZE + x);
+            if (y < BOARDSIZE-1) n.add((y+1)*BOARDSIZE + x);
+            if (x > 0) n.add(y*BOARDSIZE + x - 1);
+            if (x < BOARDSIZE-1) n.add(y*BOARDSIZE + x + 1);
 
-            if (y > 0 && x > 0) d.emplace_back((y-1)*BOARDSIZE + x -1);
-            if (y > 0 && x < BOARDSIZE-1) d.emplace_back((y-1)*BOARDSIZE + x + 1);
-            if (y < BOARDSIZE-1 && x > 0) d.emplace_back((y+1)*BOARDSIZE + x - 1);
-            if (y < BOARDSIZE-1 && x < BOARDSIZE-1) d.emplace_back((y+1)*BOARDSIZE + x + 1);
+            if (y > 0 && x > 0) d.add((y-1)*BOARDSIZE + x -1);
+            if (y > 0 && x < BOARDSIZE-1) d.add((y-1)*BOARDSIZE + x + 1);
+            if (y < BOARDSIZE-1 && x > 0) d.add((y+1)*BOARDSIZE + x - 1);
+            if (y < BOARDSIZE-1 && x < BOARDSIZE-1) d.add((y+1)*BOARDSIZE + x + 1);
         }
     }
 }
@@ -74,11 +76,17 @@ void FastBoard::reset_board() {
     m_prisoners[WHITE] = 0;
 
     std::fill(m_square.begin(), m_square.end(), EMPTY);
+    m_occupancy[BLACK].clear();
+    m_occupancy[WHITE].clear();
 
     calc_hash();
     calc_ko_hash();
 }
 
+const FastBoard::Occupancy& FastBoard::get_occupancy() const {
+    return m_occupancy;
+}
+
 bool FastBoard::is_suicide(int i, int color) const {
 
     for (auto ai : NEIGHBORS[i]) {
@@ -104,32 +112,25 @@ bool FastBoard::is_suicide(int i, int color) const {
     return true;
 }
 
-int FastBoard::calc_reach_color(int color) const {
-    auto reachable = 0;
-    auto bd = std::vector<bool>(BOARDSQ, false);
-    auto open = std::queue<int>();
-    for (auto i = 0; i < BOARDSQ; i++) {
-        if (m_square[i] == color) {
-            reachable++;
-            bd[i] = true;
-            open.push(i);
+Bitboard FastBoard::get_legal_moves(int color) const {
+    auto empty = ~(m_occupancy[BLACK] | m_occupancy[WHITE]);
+    // A move next to an empty point always has a liberty, only
+    // points surrounded by stones need a closer look.
+    auto legal = empty & empty.neighbours();
+    auto surrounded = empty & ~legal;
+    surrounded.for_each([&](int v) {
+        if (!is_suicide(v, color)) {
+            legal.set(v);
         }
-    }
-    while (!open.empty()) {
-        /* colored field, spread */
-        auto vertex = open.front();
-        open.pop();
-
-        for (auto neighbor : NEIGHBORS[vertex]) {
+    });
+    return legal;
+}
 
-            if (!bd[neighbor] && m_square[neighbor] == EMPTY) {
-                reachable++;
-                bd[neighbor] = true;
-                open.push(neighbor);
-            }
-        }
-    }
-    return reachable;
+int FastBoard::calc_reach_color(int color) const {
+    // Our stones and all empty points connected to them.
+    auto empty = ~(m_occupancy[BLACK] | m_occupancy[WHITE]);
+    auto& stones = m_occupancy[color];
+    return Bitboard::flood_fill(stones, stones | empty).count();
 }
 
 // Needed for scoring passed out games not in MC playouts
@@ -139,6 +140,105 @@ float FastBoard::area_score(float komi) const {
     return black - white - komi;
 }
 
+// Benson's algorithm: the strings of color that can't be captured
+// even if color keeps passing, plus the regions they secure.
+Bitboard FastBoard::get_pass_alive(int color) const {
+    const auto& own = m_occupancy[color];
+    const auto empty = ~(m_occupancy[BLACK] | m_occupancy[WHITE]);
+
+    // Our strings, taken from the string lists.
+    auto strings = std::vector<Bitboard>{};
+    own.for_each([&](int v) {
+        if (m_parent[v] != v) {
+            return;
+        }
+        auto string = Bitboard{};
+        auto pos = v;
+        do {
+            string.set(pos);
+            pos = m_next[pos];
+        } while (pos != v);
+        strings.emplace_back(string);
+    });
+
+    // The regions enclosed by our stones.
+    auto regions = std::vector<Bitboard>{};
+    auto covered = Bitboard{};
+    const auto others = ~own;
+    others.for_each([&](int v) {
+        if (covered.test(v)) {
+            return;
+        }
+        auto seed = Bitboard{};
+        seed.set(v);
+        auto region = Bitboard::flood_fill(seed, others);
+        covered = covered | region;
+        regions.emplace_back(region);
+    });
+
+    // A region is healthy for a string that borders it when all of
+    // its empty points are liberties of that string.
+    auto healthy = std::vector<std::vector<size_t>>(strings.size());
+    for (auto s = size_t{0}; s < strings.size(); s++) {
+        const auto border = strings[s].neighbours();
+        const auto libs = border & empty;
+        for (auto r = size_t{0}; r < regions.size(); r++) {
+            const auto& region = regions[r];
+            if ((region & border).none()) {
+                continue;
+            }
+            if ((region & empty & ~libs).none()) {
+                healthy[s].emplace_back(r);
+            }
+        }
+    }
+
+    // Drop strings with fewer than two healthy regions and regions
+    // bordering a dropped string until nothing changes.
+    auto alive_string = std::vector<bool>(strings.size(), true);
+    auto alive_region = std::vector<bool>(regions.size(), true);
+    auto alive = own;
+    auto changed = true;
+    while (changed) {
+        changed = false;
+        for (auto r = size_t{0}; r < regions.size(); r++) {
+            if (alive_region[r]
+                && !(regions[r].neighbours() & own & ~alive).none()) {
+                alive_region[r] = false;
+            }
+        }
+        for (auto s = size_t{0}; s < strings.size(); s++) {
+            if (!alive_string[s]) {
+                continue;
+            }
+            auto vital = 0;
+            for (auto r : healthy[s]) {
+                vital += alive_region[r];
+            }
+            if (vital < 2) {
+                alive_string[s] = false;
+                alive = alive & ~strings[s];
+                changed = true;
+            }
+        }
+    }
+
+    if (alive.none()) {
+        return alive;
+    }
+
+    // The other side can't live in a region where every empty point
+    // touches our living stones, so it counts as ours.
+    const auto reach = alive.neighbours();
+    auto result = alive;
+    for (auto r = size_t{0}; r < regions.size(); r++) {
+        if (alive_region[r] && (regions[r] & empty & ~reach).none()) {
+            result = result | regions[r];
+        }
+    }
+    return result;
+}
+
 void FastBoard::display_board(int lastmove) {
 
     myprintf("\n   ");
@@ -413,6 +513,7 @@ int FastBoard::remove_string(int i) {
         m_hash    ^= Zobrist::zobrist[m_square[pos]][pos];
         m_ko_hash ^= Zobrist::zobrist[m_square[pos]][pos];
 
+        m_occupancy[color].reset(pos);
         m_square[pos] = EMPTY;
 
         std::array<int, 4> nbr_pars;
@@ -495,6 +596,7 @@ int FastBoard::update_board(const int color, const int i) {
     m_ko_hash ^= Zobrist::zobrist[m_square[i]][i];
 
     m_square[i] = (square_t)color;
+    m_occupancy[color].set(i);
     m_next[i] = i;
     m_parent[i] = i;
     m_stones[i] = 1;
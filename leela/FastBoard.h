@@ -22,11 +22,13 @@
 #include "config.h"
 
 #include <array>
-#include <queue>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "Bitboard.h"
+#include "size_info.h"
+
 class FastBoard {
     friend class FastState;
 public:
@@ -51,11 +53,26 @@ public:
         BLACK = 0, WHITE = 1, EMPTY = 2
     };
 
-    static constexpr int BOARDSIZE = 19;
+    static constexpr int BOARDSIZE = zero::board_size;
     static constexpr int BOARDSQ = BOARDSIZE * BOARDSIZE;
 
-    static std::array<std::vector<int>, BOARDSQ> NEIGHBORS;
-    static std::array<std::vector<int>, BOARDSQ> DIAGS;
+    // The stones of each color, one bit per vertex.
+    using Occupancy = std::array<Bitboard, 2>;
+
+    // Up to 4 vertices, stored inline.
+    class VertexList {
+    public:
+        const int* begin() const { return m_vertices.data(); }
+        const int* end() const { return m_vertices.data() + m_count; }
+        size_t size() const { return m_count; }
+        void add(int vertex) { m_vertices[m_count++] = vertex; }
+    private:
+        std::array<int, 4> m_vertices;
+        size_t m_count{0};
+    };
+
+    static std::array<VertexList, BOARDSQ> NEIGHBORS;
+    static std::array<VertexList, BOARDSQ> DIAGS;
 
     static void init_board();
 
@@ -69,10 +86,16 @@ public:
     square_t get_square(int vertex) const ;
 
     bool is_suicide(int i, int color) const;
+    // Empty points where color can play without suicide.
+    Bitboard get_legal_moves(int color) const;
     bool is_eye(const int color, const int vtx) const;
 
     float area_score(float komi) const;
+    // Stones of color that are alive even if color only passes from
+    // now on, together with the area they secure.
+    Bitboard get_pass_alive(int color) const;
 
+    const Occupancy& get_occupancy() const;
     int get_prisoners(int side) const;
     bool black_to_move() const;
     bool white_to_move() const;
@@ -108,6 +131,7 @@ protected:
     std::array<unsigned short, BOARDSQ>    m_libs;        /* liberties per string parent */
     std::array<unsigned short, BOARDSQ>    m_stones;      /* stones per string parent */
     std::array<int, 2>                     m_prisoners;   /* prisoners per color */
+    Occupancy                              m_occupancy;   /* m_square as bitboards */
 
     int m_tomove;
     std::uint64_t m_hash;
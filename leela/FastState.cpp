@@ -39,8 +39,8 @@ void FastState::init_game(float komi) {
     m_komi = komi;
     m_passes = 0;
 
-    m_ko_hash_history.clear();
-    m_ko_hash_history.emplace_back(board.get_ko_hash());
+    clear_ko_hashes();
+    add_ko_hash(board.get_ko_hash());
 }
 
 void FastState::set_komi(float komi) {
@@ -55,8 +55,8 @@ void FastState::reset_game(void) {
     m_komove = 0;
     m_lastmove = 0;
 
-    m_ko_hash_history.clear();
-    m_ko_hash_history.push_back(board.get_ko_hash());
+    clear_ko_hashes();
+    add_ko_hash(board.get_ko_hash());
 }
 
 bool FastState::is_move_legal(int color, int vertex) {
@@ -67,6 +67,12 @@ bool FastState::is_move_legal(int color, int vertex) {
                 !board.is_suicide(vertex, color));
 }
 
+Bitboard FastState::get_legal_moves(int color) const {
+    auto legal = board.get_legal_moves(color);
+    legal.reset(m_komove);
+    return legal;
+}
+
 void FastState::play_move(int vertex) {
     play_move(board.m_tomove, vertex);
 }
@@ -97,7 +103,9 @@ void FastState::play_move(int color, int vertex) {
     }
     board.m_hash ^= Zobrist::zobrist_pass[get_passes()];
 
-    m_ko_hash_history.push_back(board.get_ko_hash());
+    auto ko_hash = board.get_ko_hash();
+    m_superko = ko_hash_seen(ko_hash);
+    add_ko_hash(ko_hash);
 }
 
 size_t FastState::get_movenum() const {
@@ -147,24 +155,54 @@ float FastState::final_score() const {
     return board.area_score(get_komi());
 }
 
+int FastState::adjudicate() const {
+    auto black = board.get_pass_alive(FastBoard::BLACK).count();
+    auto white = board.get_pass_alive(FastBoard::WHITE).count();
+    auto open = FastBoard::BOARDSQ - black - white;
+
+    // Give all the open points to one side and see if it still loses.
+    if (black - white - open - get_komi() > 0.0f) {
+        return FastBoard::BLACK;
+    }
+    if (black + open - white - get_komi() < 0.0f) {
+        return FastBoard::WHITE;
+    }
+    return FastBoard::EMPTY;
+}
+
 float FastState::get_komi() const {
     return m_komi;
 }
 
-bool FastState::superko(void) const {
-    auto first = crbegin(m_ko_hash_history);
-    auto last = crend(m_ko_hash_history);
-
-    auto res = std::find(++first, last, board.get_ko_hash());
+void FastState::clear_ko_hashes() {
+    m_ko_hash_history.clear();
+    m_ko_hash_filter.reset();
+    m_superko = false;
+}
 
-    return (res != last);
+void FastState::add_ko_hash(std::uint64_t hash) {
+    m_ko_hash_history.push_back(hash);
+    // Zobrist hashes are random, so two slices of them make
+    // independent filter indices.
+    m_ko_hash_filter.set(hash % KO_FILTER_BITS);
+    m_ko_hash_filter.set((hash >> 32) % KO_FILTER_BITS);
 }
 
-bool FastState::superko_move(const int color, const int i) const {
-    auto newhash = board.test_update_ko_hash(color, i);
+bool FastState::ko_hash_seen(std::uint64_t hash) const {
+    if (!m_ko_hash_filter.test(hash % KO_FILTER_BITS)
+        || !m_ko_hash_filter.test((hash >> 32) % KO_FILTER_BITS)) {
+        return false;
+    }
+    // Might be a false positive, check the real history.
     auto first = cbegin(m_ko_hash_history);
     auto last = cend(m_ko_hash_history);
+    return std::find(first, last, hash) != last;
+}
 
-    auto res = std::find(first, last, newhash);
-    return (res != last);
+bool FastState::superko(void) const {
+    return m_superko;
+}
+
+bool FastState::superko_move(const int color, const int i) const {
+    return ko_hash_seen(board.test_update_ko_hash(color, i));
 }
@@ -20,7 +20,9 @@
 #define FASTSTATE_H_INCLUDED
 
 #include <cstddef>
+#include <cstdint>
 #include <array>
+#include <bitset>
 #include <string>
 #include <vector>
 
@@ -34,6 +36,8 @@ public:
     void play_move(int vertex);
 
     bool is_move_legal(int color, int vertex);
+    // All legal moves of color except pass, same as is_move_legal.
+    Bitboard get_legal_moves(int color) const;
 
     void set_komi(float komi);
     float get_komi() const;
@@ -44,6 +48,9 @@ public:
     void increment_passes();
 
     float final_score() const;
+    // The winner if pass-alive groups already decide the game no
+    // matter how the rest of the board is played, EMPTY otherwise.
+    int adjudicate() const;
 
     size_t get_movenum() const;
     int get_last_move() const;
@@ -63,6 +70,19 @@ public:
 
 protected:
     void play_move(int color, int vertex);
+
+private:
+    // Bloom filter over m_ko_hash_history. Only hashes it may contain
+    // need a scan of the history, which is rare as positions hardly
+    // ever repeat.
+    static constexpr auto KO_FILTER_BITS = 8192;
+    std::bitset<KO_FILTER_BITS> m_ko_hash_filter;
+    // Did the last move repeat a position?
+    bool m_superko{false};
+
+    void clear_ko_hashes();
+    void add_ko_hash(std::uint64_t hash);
+    bool ko_hash_seen(std::uint64_t hash) const;
 };
 
 #endif
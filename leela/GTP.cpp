@@ -48,8 +48,19 @@ using namespace Utils;
 
 // Configuration flags
 int cfg_num_threads;
+bool cfg_pin_threads;
+int cfg_batch_size;
+int cfg_batch_wait;
+int cfg_nn_replicas;
 int cfg_max_playouts = 1600;
 int cfg_max_visits;
+bool cfg_allow_pondering;
+bool cfg_transpositions;
+int cfg_maintime;
+int cfg_byotime;
+int cfg_byostones;
+int cfg_byoperiods;
+int cfg_lagbuffer_cs;
 int cfg_resignpct;
 int cfg_random_cnt;
 std::uint64_t cfg_rng_seed;
@@ -66,7 +77,20 @@ int cfg_noise;
 void GTP::setup_default_parameters() {
 
     cfg_num_threads = std::max(1, std::min(SMP::get_num_cpus(), MAX_CPUS));
+    cfg_pin_threads = false;
+    cfg_batch_size = 8;
+    cfg_batch_wait = 2;
+    cfg_nn_replicas = 1;
     cfg_max_visits = std::numeric_limits<decltype(cfg_max_visits)>::max();
+    cfg_allow_pondering = true;
+    cfg_transpositions = false;
+    // No time limit unless main time or byo-yomi is given (seconds).
+    cfg_maintime = 0;
+    cfg_byotime = 0;
+    cfg_byostones = 0;
+    cfg_byoperiods = 0;
+    // Safety margin for lag on every move, in centiseconds.
+    cfg_lagbuffer_cs = 100;
     cfg_puct = 0.8f;
     cfg_softmax_temp = 1.0f;
     cfg_fpu_reduction = 0.25f;
@@ -92,7 +116,7 @@ void GTP::setup_default_parameters() {
 // Setup global objects after command line has been parsed
 void init_global_objects() {
     
-    thread_pool.initialize(cfg_num_threads);
+    thread_pool.initialize(cfg_num_threads, cfg_pin_threads);
     
         // Use deterministic random numbers for hashing
     auto rng = std::make_unique<Random>(5489);
@@ -126,12 +150,52 @@ void parse_leela_commandline(int argc, char *argv[]) {
                     cfg_num_threads = num_threads;
                 }
             } 
+        else if (opt == "--pin_threads") {
+            cfg_pin_threads = true;
+        }
+        else if (opt == "--batchsize") {
+            cfg_batch_size = std::stoi(argv[++i]);
+        }
+        else if (opt == "--batch_wait") {
+            cfg_batch_wait = std::stoi(argv[++i]);
+        }
+        else if (opt == "--nn_replicas") {
+            cfg_nn_replicas = std::stoi(argv[++i]);
+        }
         else if (opt == "--playouts" || opt == "-p") {
             cfg_max_playouts = std::stoi(argv[++i]);
         }
             else if (opt == "--visits" || opt == "-v") {
                 cfg_max_visits = std::stoi(argv[++i]);
             }
+            else if (opt == "--maintime") {
+                cfg_maintime = std::stoi(argv[++i]);
+            }
+            else if (opt == "--byoyomi") {
+                cfg_byotime = std::stoi(argv[++i]);
+            }
+            else if (opt == "--byostones") {
+                cfg_byostones = std::stoi(argv[++i]);
+            }
+            else if (opt == "--byoperiods") {
+                cfg_byoperiods = std::stoi(argv[++i]);
+            }
+            else if (opt == "--movetime") {
+                // A fixed budget per move is a byo-yomi of one stone.
+                cfg_maintime = 0;
+                cfg_byotime = std::stoi(argv[++i]);
+                cfg_byostones = 1;
+                cfg_byoperiods = 0;
+            }
+            else if (opt == "--lagbuffer_cs") {
+                cfg_lagbuffer_cs = std::stoi(argv[++i]);
+            }
+            else if (opt == "--transpositions") {
+                cfg_transpositions = true;
+            }
+            else if (opt == "--noponder") {
+                cfg_allow_pondering = false;
+            }
             else if (opt == "--resignpct" || opt == "-r") {
                 cfg_resignpct = std::stoi(argv[++i]);
             }
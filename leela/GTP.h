@@ -35,8 +35,19 @@
 
 
 extern int cfg_num_threads;
+extern bool cfg_pin_threads;
+extern int cfg_batch_size;
+extern int cfg_batch_wait;
+extern int cfg_nn_replicas;
 extern int cfg_max_playouts;
 extern int cfg_max_visits;
+extern bool cfg_allow_pondering;
+extern bool cfg_transpositions;
+extern int cfg_maintime;
+extern int cfg_byotime;
+extern int cfg_byostones;
+extern int cfg_byoperiods;
+extern int cfg_lagbuffer_cs;
 extern int cfg_resignpct;
 extern int cfg_random_cnt;
 extern std::uint64_t cfg_rng_seed;
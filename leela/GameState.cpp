@@ -34,8 +34,9 @@
 void GameState::init_game(float komi) {
     FastState::init_game(komi);
 
-    game_history.clear();
-    game_history.emplace_back(std::make_shared<FastBoard>(board));
+    game_history[0] = board.get_occupancy();
+
+    m_timecontrol.reset_clocks();
 
     m_resigned = FastBoard::EMPTY;
 }
@@ -43,8 +44,9 @@ void GameState::init_game(float komi) {
 void GameState::reset_game() {
     FastState::reset_game();
 
-    game_history.clear();
-    game_history.emplace_back(std::make_shared<FastBoard>(board));
+    game_history[0] = board.get_occupancy();
+
+    m_timecontrol.reset_clocks();
 
     m_resigned = FastBoard::EMPTY;
 }
@@ -60,9 +62,7 @@ void GameState::play_move(int color, int vertex) {
         FastState::play_move(color, vertex);
     }
 
-    // cut off any leftover moves from navigating
-    game_history.resize(m_movenum);
-    game_history.emplace_back(std::make_shared<FastBoard>(board));
+    game_history[m_movenum % HISTORY_SIZE] = board.get_occupancy();
 }
 
 int GameState::who_resigned() const {
@@ -73,15 +73,30 @@ bool GameState::has_resigned() const {
     return m_resigned != FastBoard::EMPTY;
 }
 
+void GameState::start_clock(int color) {
+    m_timecontrol.start(color);
+}
+
+void GameState::stop_clock(int color) {
+    m_timecontrol.stop(color);
+}
+
+const TimeControl& GameState::get_timecontrol() const {
+    return m_timecontrol;
+}
+
+void GameState::set_timecontrol(const TimeControl& timecontrol) {
+    m_timecontrol = timecontrol;
+}
+
 void GameState::anchor_game_history(void) {
     // handicap moves don't count in game history
     m_movenum = 0;
-    game_history.clear();
-    game_history.emplace_back(std::make_shared<FastBoard>(board));
+    game_history[0] = board.get_occupancy();
 }
 
-const FastBoard& GameState::get_past_board(int moves_ago) const {
+const FastBoard::Occupancy& GameState::get_past_occupancy(int moves_ago) const {
     assert(moves_ago >= 0 && (unsigned)moves_ago <= m_movenum);
-    assert(m_movenum + 1 <= game_history.size());
-    return *game_history[m_movenum - moves_ago];
+    assert((unsigned)moves_ago < HISTORY_SIZE);
+    return game_history[(m_movenum - moves_ago) % HISTORY_SIZE];
 }
@@ -19,14 +19,19 @@
 #ifndef GAMESTATE_H_INCLUDED
 #define GAMESTATE_H_INCLUDED
 
-#include <memory>
+#include <array>
+#include <cstddef>
 #include <string>
-#include <vector>
 
 #include "FastState.h"
+#include "TimeControl.h"
 
 class GameState : public FastState {
 public:
+    // Number of boards kept, the current one included. This is
+    // all the history the network looks at.
+    static constexpr auto HISTORY_SIZE = std::size_t{8};
+
     explicit GameState() = default;
     explicit GameState(const FastState* rhs) {
         // Copy in fields from base class.
@@ -37,7 +42,7 @@ public:
     void reset_game();
     void anchor_game_history(void);
 
-    const FastBoard& get_past_board(int moves_ago) const;
+    const FastBoard::Occupancy& get_past_occupancy(int moves_ago) const;
 
     void play_move(int color, int vertex);
     void play_move(int vertex);
@@ -45,9 +50,17 @@ public:
     bool has_resigned() const;
     int who_resigned() const;
 
+    void start_clock(int color);
+    void stop_clock(int color);
+    const TimeControl& get_timecontrol() const;
+    void set_timecontrol(const TimeControl& timecontrol);
+
 private:
-    std::vector<std::shared_ptr<const FastBoard>> game_history;
+    // Fixed size, so copying a state or playing a move never allocates.
+    // The stones after move n are at n % HISTORY_SIZE.
+    std::array<FastBoard::Occupancy, HISTORY_SIZE> game_history;
     int m_resigned{FastBoard::EMPTY};
+    TimeControl m_timecontrol;
 };
 
 #endif
@@ -71,6 +71,7 @@ Leela::Leela(const std::string& wpath)
     game = std::make_shared<GameState>();
     search = std::make_unique<UCTSearch>(*game);
     game->init_game(7.5);
+    time_settings(cfg_maintime, cfg_byotime, cfg_byostones, cfg_byoperiods);
 }
 
 /*
@@ -88,11 +89,10 @@ int Leela::selfplay(int playouts, std::vector<TimeStep>& steps, const std::strin
     cfg_noise = true;
     search->set_playout_limit(playouts);
 
-    int board[361];
+    int board[FastBoard::BOARDSQ];
     auto fill_board = [&]() {
-        auto& info = game->get_past_board(0);
-        for (int i=0; i<361; i++) {
-            auto color = info.get_square(i);
+        for (int i=0; i<FastBoard::BOARDSQ; i++) {
+            auto color = game->board.get_square(i);
             if (color == FastBoard::BLACK)
                 board[i] = 1;
             else if (color == FastBoard::WHITE)
@@ -109,13 +109,15 @@ int Leela::selfplay(int playouts, std::vector<TimeStep>& steps, const std::strin
     
     int move_cnt = 0;
     int winner = FastBoard::EMPTY;
+    auto end = MOVE_LIMIT;
     int prev_move = -1;
     std::vector<int> move_history;
     
     for(;;) {
         auto who = game->get_to_move();
-        int move = search->think(who, steps);
-        game->play_move(who, move);
+        // genmove() plays the move on our game state, then keeps
+        // searching the next position while we get back to it.
+        int move = genmove(who, steps);
         move_history.push_back(move);
         move_cnt++;
 
@@ -131,19 +133,31 @@ int Leela::selfplay(int playouts, std::vector<TimeStep>& steps, const std::strin
     
         if (move == FastBoard::RESIGN) {
             winner = !who;
+            end = RESIGNATION;
             break;
         }
         if (move == FastBoard::PASS && prev_move == FastBoard::PASS) {
+            end = PASSES;
+            break;
+        }
+        // Stop as soon as the safe groups decide the game, the rest
+        // is only filling in.
+        winner = game->adjudicate();
+        if (winner != FastBoard::EMPTY) {
+            end = ADJUDICATION;
             break;
         }
     
         prev_move = move;
     
-        if (move_cnt >= 361*2)
+        if (move_cnt >= FastBoard::BOARDSQ*2)
             break;
     }
+
+    // The game is over, stop searching before we score it.
+    search->stop_ponder();
     
-    // Nobody resigned, we will have to count
+    // Nobody resigned and the game wasn't decided early, we will have to count
     if (winner == FastBoard::EMPTY) {
         auto score = game->final_score();
         if (score < -0.1) {
@@ -161,7 +175,7 @@ int Leela::selfplay(int playouts, std::vector<TimeStep>& steps, const std::strin
     else
         result = 0;
 
-    dump_sgf(sgffile, move_history);
+    dump_sgf(sgffile, move_history, winner, end);
 
     std::cerr << "final score: " << result << std::endl;
 
@@ -169,7 +183,8 @@ int Leela::selfplay(int playouts, std::vector<TimeStep>& steps, const std::strin
 }
 
     
-bool Leela::dump_sgf(const std::string& path, const std::vector<int>& move_history) const {
+bool Leela::dump_sgf(const std::string& path, const std::vector<int>& move_history,
+                     int winner, GameEnd end) const {
     std::ofstream ofs(path);
     if (ofs.fail())
         return false;
@@ -212,10 +227,8 @@ bool Leela::dump_sgf(const std::string& path, const std::vector<int>& move_histo
     int counter = 0;
     
     int color = FastBoard::BLACK;
-    bool resigned = false;
     for (auto move : move_history) {
         if (move == FastBoard::RESIGN) {
-            resigned = true;
             break;
         }
     
@@ -232,18 +245,16 @@ bool Leela::dump_sgf(const std::string& path, const std::vector<int>& move_histo
         color = !color;
     }
     
-    if (!resigned) {
-            if (score > 0.0f) {
-                header.append("RE[B+" + format("%.1f", score) + "]");
-            } else {
-                header.append("RE[W+" + format("%.1f", -score) + "]");
-            }
+    auto winner_text = std::string{winner == FastBoard::BLACK ? "B+" : "W+"};
+    if (end == RESIGNATION) {
+        header.append("RE[" + winner_text + "Resign]");
+    } else if (end == ADJUDICATION) {
+        // Decided by the pass-alive groups, the margin isn't known.
+        header.append("RE[" + winner_text + "]");
+    } else if (winner == FastBoard::EMPTY) {
+        header.append("RE[0]");
     } else {
-            if (color == FastBoard::WHITE) {
-                header.append("RE[B+Resign]");
-            } else {
-                header.append("RE[W+Resign]");
-            }
+        header.append("RE[" + winner_text + format("%.1f", std::fabs(score)) + "]");
     }
     
     header.append("\nC[" + std::string{PROGRAM_NAME} + " options:]");
@@ -258,11 +269,29 @@ bool Leela::dump_sgf(const std::string& path, const std::vector<int>& move_histo
 }
     
 void Leela::clear_board() {
+    // Stop pondering before the board changes under the search.
+    search->stop_ponder();
     // Initialize the board.
     game->reset_game();
     search = std::make_unique<UCTSearch>(*game);
 }
+
+int Leela::genmove(int color, std::vector<TimeStep>& steps) {
+    auto move = search->think(color, steps);
+    if (cfg_allow_pondering && move != FastBoard::RESIGN) {
+        search->ponder();
+    }
+    return move;
+}
+
+void Leela::time_settings(int maintime, int byotime, int byostones, int byoperiods) {
+    // The ponder threads copy the game state, stop them first.
+    search->stop_ponder();
+    // Convert to centiseconds and set.
+    game->set_timecontrol(TimeControl(maintime * 100, byotime * 100,
+                                      byostones, byoperiods));
+}
     
 void Leela::komi(float v) {
-    game->set_komi(v);
+    search->set_komi(v);
 }
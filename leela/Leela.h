@@ -33,12 +33,23 @@ protected:
     std::unique_ptr<UCTSearch> search;
         
 public:
+    // How a selfplay game ended.
+    enum GameEnd {
+        RESIGNATION, PASSES, MOVE_LIMIT, ADJUDICATION
+    };
+
     Leela(const std::string& wpath);
     bool load_weights(const std::string& path);
     
     void clear_board();
     void komi(float);
-    bool dump_sgf(const std::string& path, const std::vector<int>& move_history) const;
+    // Search and play a move for color. With pondering enabled the
+    // search continues in the background until the next move.
+    int genmove(int color, std::vector<TimeStep>& steps);
+    // Clock handling, times are in seconds as in GTP.
+    void time_settings(int maintime, int byotime, int byostones, int byoperiods);
+    bool dump_sgf(const std::string& path, const std::vector<int>& move_history,
+                  int winner, GameEnd end) const;
 
     int selfplay(int playouts, std::vector<TimeStep>& steps, const std::string& sgffile, std::function<void(int, int[])> callback);
 };
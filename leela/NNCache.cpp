@@ -17,72 +17,163 @@
 */
 
 #include "config.h"
-#include <functional>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <new>
 
 #include "NNCache.h"
 #include "Utils.h"
 
-NNCache::NNCache(int size) : m_size(size) {}
+NNCache::NNCache(int size) {
+    resize(size);
+}
 
 NNCache& NNCache::get_NNCache(void) {
     static NNCache cache;
     return cache;
 }
 
+std::uint8_t NNCache::encode_policy(float policy) {
+    auto code = std::round(-std::log(policy) * POLICY_SCALE);
+    // Also catches NaN from log(0).
+    if (!(code < POLICY_ABSENT - 1)) {
+        return POLICY_ABSENT - 1;
+    }
+    return static_cast<std::uint8_t>(std::max(0.0f, code));
+}
+
+float NNCache::decode_policy(std::uint8_t code) {
+    static const auto table = [] {
+        auto table = std::array<float, POLICY_ABSENT>{};
+        for (auto i = size_t{0}; i < table.size(); i++) {
+            table[i] = std::exp(-float(i) / POLICY_SCALE);
+        }
+        return table;
+    }();
+    return table[code];
+}
+
 bool NNCache::lookup(std::uint64_t hash, Network::Netresult & result) {
-    std::lock_guard<std::mutex> lock(m_mutex);
     ++m_lookups;
 
-    auto iter = m_cache.find(hash);
-    if (iter == m_cache.end()) {
-        return false;  // Not found.
+    for (auto probe = size_t{0}; probe < PROBE_WINDOW; probe++) {
+        auto& entry = slot(hash, probe);
+
+        auto seq = entry.seq.load(std::memory_order_acquire);
+        if (seq == 0 || entry.hash.load(std::memory_order_relaxed) != hash) {
+            continue;
+        }
+        if (seq & 1) {
+            ++m_contended;
+            return false;  // Being written, treat as a miss.
+        }
+
+        // Found it, copy it out and check nobody wrote to it meanwhile.
+        auto& moves = result.first;
+        moves.clear();
+        for (auto idx = size_t{0}; idx < POLICY_SIZE; idx++) {
+            auto code = entry.policy[idx];
+            if (code != POLICY_ABSENT) {
+                auto vertex = idx < FastBoard::BOARDSQ ? int(idx) : FastBoard::PASS;
+                moves.emplace_back(decode_policy(code), vertex);
+            }
+        }
+        result.second = entry.winrate;
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (entry.seq.load(std::memory_order_relaxed) != seq) {
+            ++m_contended;
+            return false;
+        }
+
+        ++m_hits;
+        return true;
     }
 
-    const auto& entry = iter->second;
-
-    // Found it.
-    ++m_hits;
-    result = entry->result;
-    return true;
+    return false;  // Not found.
 }
 
 void NNCache::insert(std::uint64_t hash,
                      const Network::Netresult& result) {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    // Pick an empty slot, otherwise replace the oldest one.
+    auto victim = static_cast<Entry*>(nullptr);
+    for (auto probe = size_t{0}; probe < PROBE_WINDOW; probe++) {
+        auto& entry = slot(hash, probe);
+
+        if (entry.seq.load(std::memory_order_acquire) == 0) {
+            victim = &entry;
+            break;
+        }
+        if (entry.hash.load(std::memory_order_relaxed) == hash) {
+            return;  // Already in the cache.
+        }
+        if (!victim || entry.age.load(std::memory_order_relaxed)
+                       < victim->age.load(std::memory_order_relaxed)) {
+            victim = &entry;
+        }
+    }
 
-    if (m_cache.find(hash) != m_cache.end()) {
-        return;  // Already in the cache.
+    // Take the slot. If another thread is writing it, just drop this
+    // result rather than wait for it.
+    auto seq = victim->seq.load(std::memory_order_relaxed);
+    if ((seq & 1)
+        || !victim->seq.compare_exchange_strong(seq, seq + 1,
+                                                std::memory_order_acquire)) {
+        ++m_contended;
+        return;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+
+    victim->hash.store(hash, std::memory_order_relaxed);
+    victim->age.store(++m_inserts, std::memory_order_relaxed);
+    victim->winrate = result.second;
+    victim->policy.fill(POLICY_ABSENT);
+    for (const auto& node : result.first) {
+        auto idx = node.second == FastBoard::PASS ? FastBoard::BOARDSQ : node.second;
+        victim->policy[idx] = encode_policy(node.first);
     }
 
-    m_cache.emplace(hash, std::make_unique<Entry>(result));
-    m_order.push_back(hash);
-    ++m_inserts;
+    victim->seq.store(seq + 2, std::memory_order_release);
+}
 
-    // If the cache is too large, remove the oldest entry.
-    if (m_order.size() > m_size) {
-        m_cache.erase(m_order.front());
-        m_order.pop_front();
+void NNCache::resize(int size) {
+    m_size = std::max(int(PROBE_WINDOW), size);
+    m_storage = std::make_unique<char[]>(m_size * sizeof(Entry) + alignof(Entry));
+
+    auto space = m_size * sizeof(Entry) + alignof(Entry);
+    void* ptr = m_storage.get();
+    m_table = static_cast<Entry*>(std::align(alignof(Entry), m_size * sizeof(Entry),
+                                             ptr, space));
+    for (auto i = size_t{0}; i < m_size; i++) {
+        new (&m_table[i]) Entry();
     }
+    clear();
 }
 
-void NNCache::resize(int size) {
-    m_size = size;
-    while (m_order.size() > m_size) {
-        m_cache.erase(m_order.front());
-        m_order.pop_front();
+void NNCache::clear() {
+    m_hits = 0;
+    m_lookups = 0;
+    m_inserts = 0;
+    m_contended = 0;
+    for (auto i = size_t{0}; i < m_size; i++) {
+        m_table[i].seq = 0;
+        m_table[i].age = 0;
+        m_table[i].hash = 0;
     }
 }
 
 void NNCache::set_size_from_playouts(int max_playouts) {
     // cache hits are generally from last several moves so setting cache
     // size based on playouts increases the hit rate while balancing memory
-    // usage for low playout instances. 50'000 cache entries is ~250 MB
-    auto max_size = std::min(50'000, std::max(6'000, 3 * max_playouts));
+    // usage for low playout instances. 400'000 cache entries is ~150 MB
+    auto max_size = std::min(400'000, std::max(6'000, 3 * max_playouts));
     NNCache::get_NNCache().resize(max_size);
 }
 
 void NNCache::dump_stats() {
-    Utils::myprintf("NNCache: %d/%d hits/lookups = %.1f%% hitrate, %d inserts, %u size\n",
-        m_hits, m_lookups, 100. * m_hits / (m_lookups + 1),
-        m_inserts, m_cache.size());
+    Utils::myprintf("NNCache: %d/%d hits/lookups = %.1f%% hitrate, %d misses, %d contended, %d inserts, %u size\n",
+        int{m_hits}, int{m_lookups}, 100. * m_hits / (m_lookups + 1),
+        m_lookups - m_hits, int{m_contended}, int{m_inserts},
+        static_cast<unsigned>(m_size));
 }
@@ -21,10 +21,12 @@
 
 #include "config.h"
 
-#include <deque>
-#include <mutex>
-#include <unordered_map>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
 
+#include "FastBoard.h"
 #include "Network.h"
 
 class NNCache {
@@ -35,7 +37,8 @@ public:
     // Set a reasonable size gives max number of playouts
     void set_size_from_playouts(int max_playouts);
 
-    // Resize NNCache
+    // Resize NNCache. This drops all entries and must not
+    // run concurrently with lookup or insert.
     void resize(int size);
 
     // Try and find an existing entry.
@@ -52,36 +55,60 @@ public:
 
     void dump_stats();
 
-    void clear() {
-        m_hits = 0;
-        m_lookups = 0;
-        m_inserts = 0;
-        m_cache.clear();
-        m_order.clear();
-    }
+    // Drop all entries, same restrictions as resize.
+    void clear();
 
 private:
-    NNCache(int size = 50000);  // ~ 250MB
+    NNCache(int size = 50000);  // ~ 20MB
+
+    // A position can be stored in any of this many consecutive
+    // slots starting at its home slot.
+    static constexpr auto PROBE_WINDOW = size_t{4};
+
+    // Policy is indexed by vertex, pass is stored last.
+    static constexpr auto POLICY_SIZE = FastBoard::BOARDSQ + 1;
+
+    // Policy values are stored as round(-ln(p) * POLICY_SCALE), clamped
+    // to [0, POLICY_ABSENT - 1], which is accurate to about 4%.
+    // POLICY_ABSENT marks moves that are not in the Netresult.
+    static constexpr auto POLICY_SCALE = 12.0f;
+    static constexpr auto POLICY_ABSENT = std::uint8_t{255};
+
+    static std::uint8_t encode_policy(float policy);
+    static float decode_policy(std::uint8_t code);
+
+    // One slot of the table, guarded by a sequence lock: seq is odd while
+    // a writer is updating the slot and even otherwise. Readers never
+    // block, they compare seq before and after copying the payload and
+    // treat a torn read as a miss. seq == 0 marks a never written slot.
+    struct alignas(64) Entry {
+        std::atomic<std::uint32_t> seq;
+        std::atomic<std::uint32_t> age;    // insert count when written
+        std::atomic<std::uint64_t> hash;
+        float winrate;
+        std::array<std::uint8_t, POLICY_SIZE> policy;
+    };
+    // Six cache lines per position on 19x19, two on 9x9.
+    static_assert(sizeof(Entry) == (20 + POLICY_SIZE + 63) / 64 * 64,
+                  "Unexpected NNCache::Entry size");
 
-    std::mutex m_mutex;
+    Entry& slot(std::uint64_t hash, size_t probe) {
+        return m_table[(hash + probe) % m_size];
+    }
 
     size_t m_size;
 
-    // Statistics
-    int m_hits{0};
-    int m_lookups{0};
-    int m_inserts{0};
-
-    struct Entry {
-        Entry( const Network::Netresult& r)
-            : result(r) {}
-        Network::Netresult result;  // ~ 3KB
-    };
+    // Preallocated table, m_table points to the first cache line
+    // aligned Entry inside m_storage.
+    std::unique_ptr<char[]> m_storage;
+    Entry* m_table{nullptr};
 
-    // Map from hash to {features, result}
-    std::unordered_map<std::uint64_t, std::unique_ptr<const Entry>> m_cache;
-    // Order entries were added to the map.
-    std::deque<size_t> m_order;
+    // Statistics
+    std::atomic<int> m_hits{0};
+    std::atomic<int> m_lookups{0};
+    std::atomic<int> m_inserts{0};
+    // lookups or inserts that ran into a slot being written
+    std::atomic<int> m_contended{0};
 };
 
 #endif
@@ -0,0 +1,136 @@
+/*
+    This file is part of Leela Zero.
+
+    Leela Zero is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Leela Zero is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Leela Zero.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+#include "NNQueue.h"
+
+#include <algorithm>
+#include <cassert>
+#include <exception>
+
+#include "GTP.h"
+#include "Utils.h"
+#include "nn.h"
+
+NNQueue& NNQueue::get_NNQueue(void) {
+    static NNQueue queue;
+    return queue;
+}
+
+NNQueue::~NNQueue() {
+    shutdown();
+}
+
+void NNQueue::initialize(std::shared_ptr<zero_model> net, int replicas,
+                         int batch_size, int wait_ms) {
+    shutdown();
+
+    m_batch_size = std::max(1, batch_size);
+    m_wait = std::chrono::milliseconds(std::max(0, wait_ms));
+    m_batches = 0;
+    m_evals = 0;
+
+    m_exit = false;
+    for (int i = 0; i < std::max(1, replicas); i++) {
+        // The replicas share the weights of net, only the
+        // activations are private to each worker.
+        auto replica = (i == 0 ? net : std::make_shared<zero_model>(*net));
+        m_workers.emplace_back([this, replica] { worker(replica); });
+    }
+}
+
+void NNQueue::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_exit = true;
+    }
+    m_condvar.notify_all();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+    m_workers.clear();
+}
+
+NNQueue::Netresult NNQueue::forward(std::vector<float>&& planes) {
+    Request req;
+    req.planes = std::move(planes);
+    auto result = req.result.get_future();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.push_back(&req);
+    }
+    m_condvar.notify_one();
+    return result.get();
+}
+
+void NNQueue::worker(std::shared_ptr<zero_model> net) {
+    std::vector<Request*> batch;
+    for (;;) {
+        batch.clear();
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condvar.wait(lock, [this]{ return m_exit || !m_queue.empty(); });
+            if (m_queue.empty()) {
+                return;
+            }
+            // Give the other search threads a chance to fill up the batch.
+            if (m_queue.size() < m_batch_size && !m_exit) {
+                m_condvar.wait_for(lock, m_wait, [this]{
+                    return m_exit || m_queue.size() >= m_batch_size;
+                });
+            }
+            while (!m_queue.empty() && batch.size() < m_batch_size) {
+                batch.emplace_back(m_queue.front());
+                m_queue.pop_front();
+            }
+        }
+        if (batch.empty()) {
+            continue;
+        }
+
+        std::vector<zero_model::result> results;
+        try {
+            auto planes_size = batch.front()->planes.size();
+            auto input = net->input_buffer(batch.size());
+            for (auto req : batch) {
+                assert(req->planes.size() == planes_size);
+                std::copy(begin(req->planes), end(req->planes), input);
+                input += planes_size;
+            }
+            results = net->forward_batch(cfg_softmax_temp);
+        } catch (...) {
+            for (auto req : batch) {
+                req->result.set_exception(std::current_exception());
+            }
+            continue;
+        }
+
+        for (size_t i = 0; i < batch.size(); i++) {
+            batch[i]->result.set_value(std::move(results[i]));
+        }
+
+        m_batches++;
+        m_evals += batch.size();
+    }
+}
+
+void NNQueue::dump_stats() {
+    Utils::myprintf("NNQueue: %d evaluations in %d batches, %.2f avg batch size (max %d), %d replica(s)\n",
+        int{m_evals}, int{m_batches},
+        static_cast<double>(m_evals) / std::max(1, int{m_batches}),
+        static_cast<int>(m_batch_size), get_replicas());
+}
@@ -0,0 +1,85 @@
+/*
+    This file is part of Leela Zero.
+
+    Leela Zero is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Leela Zero is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Leela Zero.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef NNQUEUE_H_INCLUDED
+#define NNQUEUE_H_INCLUDED
+
+#include "config.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class zero_model;
+
+class NNQueue {
+public:
+    // policy over all board_moves, winrate of the side to move in [-1, 1]
+    using Netresult = std::pair<std::vector<float>, float>;
+
+    // return the global NNQueue
+    static NNQueue& get_NNQueue(void);
+
+    // (Re)start the evaluation workers, one per replica of the net.
+    // Up to batch_size queued positions are run through a replica
+    // together, waiting at most wait_ms for the batch to fill up.
+    void initialize(std::shared_ptr<zero_model> net, int replicas,
+                    int batch_size, int wait_ms);
+
+    // Queue one position (input planes as filled by
+    // Network::gather_features) and block until it has been evaluated.
+    Netresult forward(std::vector<float>&& planes);
+
+    void dump_stats();
+
+    int get_replicas() const { return static_cast<int>(m_workers.size()); }
+
+    ~NNQueue();
+
+private:
+    NNQueue() = default;
+
+    struct Request {
+        std::vector<float> planes;
+        std::promise<Netresult> result;
+    };
+
+    void worker(std::shared_ptr<zero_model> net);
+    void shutdown();
+
+    std::mutex m_mutex;
+    std::condition_variable m_condvar;
+    std::deque<Request*> m_queue;
+    std::vector<std::thread> m_workers;
+    bool m_exit{false};
+
+    size_t m_batch_size{1};
+    std::chrono::milliseconds m_wait{0};
+
+    // Statistics
+    std::atomic<int> m_batches{0};
+    std::atomic<int> m_evals{0};
+};
+
+#endif
@@ -25,9 +25,11 @@
 #include <cassert>
 #include <cmath>
 #include <iterator>
+#include <limits>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <tuple>
 
 #ifdef __APPLE__
 #include <Accelerate/Accelerate.h>
@@ -43,40 +45,77 @@
 #include "GameState.h"
 #include "GTP.h"
 #include "NNCache.h"
+#include "NNQueue.h"
 #include "Random.h"
 #include "ThreadPool.h"
 #include "Timing.h"
 #include "Utils.h"
+#include "Zobrist.h"
 #include "nn.h"
 
-static std::mutex mtx_;
 std::shared_ptr<zero_model> zero_net;
 
 using namespace Utils;
 
+static_assert(Network::INPUT_MOVES <= GameState::HISTORY_SIZE,
+              "GameState doesn't keep enough history for the network.");
+
 // Rotation helper
-static std::array<std::array<int, 361>, 8> rotate_nn_idx_table;
+static std::array<std::array<int, FastBoard::BOARDSQ>, 8> rotate_nn_idx_table;
+// inverse_nn_idx_table[s][rotate_nn_idx_table[s][v]] == v
+static std::array<std::array<int, FastBoard::BOARDSQ>, 8> inverse_nn_idx_table;
+
+// Start the evaluation queue with the given number of net replicas.
+static void start_nn_queue(int replicas) {
+    // There is no point in keeping more replicas busy or waiting for
+    // more positions than there are search threads to produce them.
+    replicas = std::max(1, std::min(replicas, cfg_num_threads));
+    auto batch_size = std::max(1, std::min(cfg_batch_size,
+                                           cfg_num_threads / replicas));
+    NNQueue::get_NNQueue().initialize(zero_net, replicas,
+                                      batch_size, cfg_batch_wait);
+}
 
 void Network::benchmark(const GameState * state, int iterations) {
     int cpus = cfg_num_threads;
     int iters_per_thread = (iterations + (cpus - 1)) / cpus;
 
-    Time start;
-
-    ThreadGroup tg(thread_pool);
-    for (int i = 0; i < cpus; i++) {
-        tg.add_task([iters_per_thread, state]() {
-            for (int loop = 0; loop < iters_per_thread; loop++) {
-                auto vec = get_scored_moves(state, Ensemble::RANDOM_ROTATION, -1, true);
-            }
-        });
-    };
-    tg.wait_all();
-
-    Time end;
-    auto elapsed = Time::timediff_seconds(start,end);
-    myprintf("%5d evaluations in %5.2f seconds -> %d n/s\n",
-             iterations, elapsed, (int)(iterations / elapsed));
+    // Measure how throughput scales with the number of replicas,
+    // doubling up to the configured amount.
+    auto max_replicas = std::max(1, std::min(cfg_nn_replicas, cfg_num_threads));
+    auto base_rate = 0.0;
+    for (int replicas = 1; ; replicas = std::min(2 * replicas, max_replicas)) {
+        start_nn_queue(replicas);
+
+        Time start;
+
+        ThreadGroup tg(thread_pool);
+        for (int i = 0; i < cpus; i++) {
+            tg.add_task([iters_per_thread, state]() {
+                for (int loop = 0; loop < iters_per_thread; loop++) {
+                    auto vec = get_scored_moves(state, Ensemble::RANDOM_ROTATION, -1, true);
+                }
+            });
+        };
+        tg.wait_all();
+
+        Time end;
+        auto elapsed = Time::timediff_seconds(start,end);
+        auto rate = iterations / elapsed;
+        if (replicas == 1) {
+            base_rate = rate;
+        }
+        myprintf("%2d replica(s): %5d evaluations in %5.2f seconds -> %d n/s (%.2fx)\n",
+                 replicas, iterations, elapsed,
+                 (int)rate, rate / base_rate);
+        NNQueue::get_NNQueue().dump_stats();
+
+        if (replicas >= max_replicas) {
+            break;
+        }
+    }
+
+    start_nn_queue(cfg_nn_replicas);
 }
 
 std::pair<int, int> Network::load_network_file(std::string filename) {
@@ -88,14 +127,17 @@ std::pair<int, int> Network::load_network_file(std::string filename) {
 
     NNCache::get_NNCache().clear();
 
+    start_nn_queue(cfg_nn_replicas);
+
     return {zero::RESIDUAL_FILTERS, zero::RESIDUAL_BLOCKS};
 }
 
 void Network::initialize(void) {
     // Prepare rotation table
     for(auto s = 0; s < 8; s++) {
-        for(auto v = 0; v < 19 * 19; v++) {
+        for(auto v = 0; v < FastBoard::BOARDSQ; v++) {
             rotate_nn_idx_table[s][v] = rotate_nn_idx(v, s);
+            inverse_nn_idx_table[s][rotate_nn_idx(v, s)] = v;
         }
     }
 
@@ -113,9 +155,20 @@ Network::Netresult Network::get_scored_moves(
     const GameState* state, Ensemble ensemble, int rotation, bool skip_cache) {
     Netresult result;
 
+    // The cache holds results for the canonical orientation of
+    // the position, so all 8 symmetric positions share an entry.
+    std::uint64_t hash;
+    int symmetry;
+    std::tie(hash, symmetry) = get_symmetry_hash(state);
+
     // See if we already have this in the cache.
     if (!skip_cache) {
-      if (NNCache::get_NNCache().lookup(state->board.get_hash(), result)) {
+      if (NNCache::get_NNCache().lookup(hash, result)) {
+        for (auto& node : result.first) {
+          if (node.second != FastBoard::PASS) {
+            node.second = rotate_nn_idx_table[symmetry][node.second];
+          }
+        }
         return result;
       }
     }
@@ -131,35 +184,65 @@ Network::Netresult Network::get_scored_moves(
     }
 
     // Insert result into cache.
-    NNCache::get_NNCache().insert(state->board.get_hash(), result);
+    auto canonical = result;
+    for (auto& node : canonical.first) {
+        if (node.second != FastBoard::PASS) {
+            node.second = inverse_nn_idx_table[symmetry][node.second];
+        }
+    }
+    NNCache::get_NNCache().insert(hash, canonical);
 
     return result;
 }
 
+std::pair<std::uint64_t, int> Network::get_symmetry_hash(const GameState* state) {
+    // Everything but the stones and the ko square is
+    // the same in all orientations.
+    auto common = static_cast<std::uint64_t>(Zobrist::zobrist_empty);
+    common ^= Zobrist::zobrist_pris[0][state->board.get_prisoners(FastBoard::BLACK)];
+    common ^= Zobrist::zobrist_pris[1][state->board.get_prisoners(FastBoard::WHITE)];
+    common ^= Zobrist::zobrist_pass[state->get_passes()];
+    if (state->get_to_move() == FastBoard::BLACK) {
+        common ^= Zobrist::zobrist_blacktomove;
+    }
+
+    auto best = std::make_pair(std::numeric_limits<std::uint64_t>::max(), 0);
+    for (auto s = 0; s < 8; s++) {
+        auto hash = common;
+        for (auto v = 0; v < FastBoard::BOARDSQ; v++) {
+            auto color = state->board.get_square(rotate_nn_idx_table[s][v]);
+            hash ^= Zobrist::zobrist[color][v];
+        }
+        // 0 means no ko square.
+        auto komove = state->m_komove ? inverse_nn_idx_table[s][state->m_komove] : 0;
+        hash ^= Zobrist::zobrist_ko[komove];
+
+        best = std::min(best, std::make_pair(hash, s));
+    }
+    return best;
+}
+
 Network::Netresult Network::get_scored_moves_internal(
     const GameState* state, int rotation) {
     assert(rotation >= 0 && rotation <= 7);
 
-    std::pair<std::vector<float>, float>  out;
-    {
-        std::lock_guard<std::mutex> lock(mtx_);
-        gather_features(state, zero_net->input_buffer(), rotation);
-        out = zero_net->forward_net(cfg_softmax_temp);
-    }
+    auto planes = std::vector<float>(INPUT_CHANNELS * FastBoard::BOARDSQ);
+    gather_features(state, planes.data(), rotation);
+    auto out = NNQueue::get_NNQueue().forward(std::move(planes));
+
     float winrate_out = out.second;
     auto& outputs = out.first;
 
     // Sigmoid
     auto winrate_sig = (1.0f + winrate_out) / 2.0f;
 
+    // Illegal moves are masked out when the node is expanded.
     std::vector<scored_node> result;
+    result.reserve(outputs.size());
     for (auto idx = size_t{0}; idx < outputs.size(); idx++) {
         if (idx < FastBoard::BOARDSQ) {
-            auto val = outputs[idx];
             auto rot_idx = rotate_nn_idx_table[rotation][idx];
-            if (state->board.get_square(rot_idx) == FastBoard::EMPTY) {
-                result.emplace_back(val, rot_idx);
-            }
+            result.emplace_back(outputs[idx], rot_idx);
         } else {
             result.emplace_back(outputs[idx], FastBoard::PASS);
         }
@@ -182,22 +265,16 @@ void Network::gather_features(const GameState* state, float* dest, int rotation)
     // Go back in time, fill history boards
     for (auto h = size_t{0}; h < moves; h++) {
 
-        auto& board = state->get_past_board(h);
+        auto& stones = state->get_past_occupancy(h);
+        auto& my_stones = stones[to_move];
+        auto& opp_stones = stones[!to_move];
         auto me = dest + h * FastBoard::BOARDSQ;
         auto opp = me + INPUT_MOVES * FastBoard::BOARDSQ;
 
         for(int idx = 0; idx < FastBoard::BOARDSQ; idx++) {
-
             auto rot_idx = rotate_nn_idx_table[rotation][idx];
-            auto color = board.get_square(rot_idx);
-
-            if (color != FastBoard::EMPTY) {
-                if (color == to_move) {
-                    me[idx] = 1;
-                } else {
-                    opp[idx] = 1;
-                }
-            }
+            me[idx] = my_stones.test(rot_idx);
+            opp[idx] = opp_stones.test(rot_idx);
         }
     }
 
@@ -213,21 +290,6 @@ void Network::gather_features(const GameState* state, std::vector<float> & plane
     gather_features(state, &planes[0], 0);
 }
 
-void Network::fill_input_plane_pair(const FastBoard& board,
-                                    BoardPlane& black, BoardPlane& white) {
-    for(int idx = 0; idx < FastBoard::BOARDSQ; idx++) {
-        auto color = board.get_square(idx);
-        if (color != FastBoard::EMPTY) {
-            if (color == FastBoard::BLACK) {
-                black[idx] = true;
-            } else {
-                white[idx] = true;
-            }
-        }
-    }
-}
-
-
 void Network::gather_features(const GameState* state, NNPlanes & planes) {
     planes.resize(INPUT_CHANNELS);
     BoardPlane& black_to_move = planes[2 * INPUT_MOVES];
@@ -249,41 +311,12 @@ void Network::gather_features(const GameState* state, NNPlanes & planes) {
     // Go back in time, fill history boards
     for (auto h = size_t{0}; h < moves; h++) {
         // collect white, black occupation planes
-        fill_input_plane_pair(state->get_past_board(h),
-                              planes[black_offset + h],
-                              planes[white_offset + h]);
+        auto& stones = state->get_past_occupancy(h);
+        planes[black_offset + h] = stones[FastBoard::BLACK].to_bitset();
+        planes[white_offset + h] = stones[FastBoard::WHITE].to_bitset();
     }
 }
 
 int Network::rotate_nn_idx(const int vertex, int symmetry) {
-    assert(vertex >= 0 && vertex < 19*19);
-    assert(symmetry >= 0 && symmetry < 8);
-    int x = vertex % 19;
-    int y = vertex / 19;
-    int newx;
-    int newy;
-
-    if (symmetry >= 4) {
-        std::swap(x, y);
-        symmetry -= 4;
-    }
-
-    if (symmetry == 0) {
-        newx = x;
-        newy = y;
-    } else if (symmetry == 1) {
-        newx = x;
-        newy = 19 - y - 1;
-    } else if (symmetry == 2) {
-        newx = 19 - x - 1;
-        newy = y;
-    } else {
-        assert(symmetry == 3);
-        newx = 19 - x - 1;
-        newy = 19 - y - 1;
-    }
-
-    int newvtx = (newy * 19) + newx;
-    assert(newvtx >= 0 && newvtx < 19*19);
-    return newvtx;
+    return zero::board_info::rotate_vertex(vertex, symmetry);
 }
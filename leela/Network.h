@@ -23,6 +23,7 @@
 
 #include <array>
 #include <bitset>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <utility>
@@ -38,7 +39,7 @@ public:
         DIRECT, RANDOM_ROTATION
     };
 
-    using BoardPlane = std::bitset<19*19>;
+    using BoardPlane = std::bitset<FastBoard::BOARDSQ>;
     using NNPlanes = std::vector<BoardPlane>;
     using scored_node = std::pair<float, int>;
     using Netresult = std::pair<std::vector<scored_node>, float>;
@@ -54,10 +55,6 @@ public:
     static constexpr auto OUTPUTS_POLICY = 2;
     static constexpr auto OUTPUTS_VALUE = 1;
 
-    // Winograd filter transformation changes 3x3 filters to 4x4
-    static constexpr auto WINOGRAD_ALPHA = 4;
-    static constexpr auto WINOGRAD_TILE = WINOGRAD_ALPHA * WINOGRAD_ALPHA;
-
     static void initialize();
     static void benchmark(const GameState * state, int iterations = 1600);
 
@@ -68,10 +65,10 @@ public:
 
     static std::pair<int, int> load_network_file(std::string filename);
 private:
-    static void fill_input_plane_pair(const FastBoard& board,
-                                    BoardPlane& black, BoardPlane& white);
-
     static int rotate_nn_idx(const int vertex, int symmetry);
+    // Hash of the position in its canonical orientation, i.e. the
+    // symmetry with the smallest hash, and that symmetry.
+    static std::pair<std::uint64_t, int> get_symmetry_hash(const GameState* state);
     static Netresult get_scored_moves_internal(
       const GameState* state, int rotation);
 };
@@ -0,0 +1,78 @@
+/*
+    This file is part of Leela Zero.
+
+    Leela Zero is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Leela Zero is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Leela Zero.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "config.h"
+#include "NodeArena.h"
+
+#include <algorithm>
+#include <cstddef>
+
+std::atomic<std::uint64_t> NodeArena::s_next_id{1};
+
+namespace {
+    // The chunk the current thread is allocating from.
+    struct ChunkCursor {
+        std::uint64_t arena_id{0};
+        char* next{nullptr};
+        char* end{nullptr};
+    };
+    thread_local ChunkCursor t_cursor;
+
+    constexpr auto ALIGNMENT = alignof(std::max_align_t);
+
+    size_t align_up(size_t size) {
+        return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    }
+}
+
+NodeArena::NodeArena() : m_id(s_next_id++) {}
+
+void* NodeArena::allocate(size_t size) {
+    size = align_up(size);
+    auto& cursor = t_cursor;
+    if (cursor.arena_id != m_id || size_t(cursor.end - cursor.next) < size) {
+        return new_chunk(size);
+    }
+    auto ptr = cursor.next;
+    cursor.next += size;
+    return ptr;
+}
+
+void* NodeArena::new_chunk(size_t size) {
+    // new[] only guarantees alignment for fundamental types,
+    // leave room to align the start of the chunk.
+    auto chunk_size = std::max(CHUNK_SIZE, size) + ALIGNMENT;
+    auto chunk = std::unique_ptr<char[]>(new char[chunk_size]);
+
+    auto start = reinterpret_cast<char*>(
+        align_up(reinterpret_cast<std::uintptr_t>(chunk.get())));
+
+    auto& cursor = t_cursor;
+    cursor.arena_id = m_id;
+    cursor.next = start + size;
+    cursor.end = chunk.get() + chunk_size;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_chunks.emplace_back(std::move(chunk));
+    return start;
+}
+
+size_t NodeArena::get_chunks() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_chunks.size();
+}
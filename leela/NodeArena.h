@@ -0,0 +1,61 @@
+/*
+    This file is part of Leela Zero.
+
+    Leela Zero is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Leela Zero is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Leela Zero.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef NODEARENA_H_INCLUDED
+#define NODEARENA_H_INCLUDED
+
+#include "config.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Bump allocator for the search tree. Every thread carves its
+// allocations out of its own chunk, so allocating only takes a lock
+// when a thread needs a new chunk. Memory is never freed individually,
+// all of it is released at once when the arena is destroyed, so only
+// trivially destructible objects should be placed in it.
+class NodeArena {
+public:
+    NodeArena();
+
+    // Return uninitialized memory for size bytes, aligned for any type.
+    void* allocate(size_t size);
+
+    size_t get_chunks();
+
+private:
+    static constexpr auto CHUNK_SIZE = size_t{1} << 20;
+
+    // Allocate a new chunk of at least size bytes and make it
+    // the current chunk of the calling thread.
+    void* new_chunk(size_t size);
+
+    std::mutex m_mutex;
+    std::vector<std::unique_ptr<char[]>> m_chunks;
+
+    // Unique for every arena ever created, so threads can tell whether
+    // their current chunk belongs to this arena.
+    const std::uint64_t m_id;
+    static std::atomic<std::uint64_t> s_next_id;
+};
+
+#endif
@@ -18,10 +18,56 @@
 
 #include "SMP.h"
 
+#include <cassert>
 #include <thread>
 
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+#include <immintrin.h>
+#endif
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    std::atomic<int> s_contended{0};
+    std::atomic<int> s_parked{0};
+
+    // Spin rounds double up to this many pauses before we sleep.
+    constexpr auto MAX_SPIN_ROUND = 64;
+
+    inline void cpu_relax() {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+        _mm_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
+    }
+
+    void futex_wait(std::atomic<int>& word, int value) {
+#ifdef __linux__
+        syscall(SYS_futex, reinterpret_cast<int*>(&word),
+                FUTEX_WAIT_PRIVATE, value, nullptr, nullptr, 0);
+#else
+        (void)word;
+        (void)value;
+        std::this_thread::yield();
+#endif
+    }
+
+    void futex_wake(std::atomic<int>& word) {
+#ifdef __linux__
+        syscall(SYS_futex, reinterpret_cast<int*>(&word),
+                FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#else
+        (void)word;
+#endif
+    }
+}
+
 SMP::Mutex::Mutex() {
-    m_lock = false;
+    m_lock = 0;
 }
 
 SMP::Lock::Lock(Mutex & m) {
@@ -30,15 +76,61 @@ SMP::Lock::Lock(Mutex & m) {
 }
 
 void SMP::Lock::lock() {
-    while (m_mutex->m_lock.exchange(true, std::memory_order_acquire) == true);
+    assert(!m_owns_lock);
+    m_owns_lock = true;
+    auto& state = m_mutex->m_lock;
+    auto expected = 0;
+    if (state.compare_exchange_strong(expected, 1, std::memory_order_acquire)) {
+        return;
+    }
+    s_contended.fetch_add(1, std::memory_order_relaxed);
+
+    // Test and test-and-set, so waiting threads only read the lock
+    // and don't keep stealing its cache line from the holder.
+    for (auto round = 1; round <= MAX_SPIN_ROUND; round *= 2) {
+        for (auto i = 0; i < round; i++) {
+            cpu_relax();
+        }
+        if (state.load(std::memory_order_relaxed) == 0) {
+            expected = 0;
+            if (state.compare_exchange_strong(expected, 1,
+                                              std::memory_order_acquire)) {
+                return;
+            }
+        }
+    }
+
+    // The holder is probably descheduled, sleep instead of
+    // taking cycles away from it. Mark the lock so that
+    // unlock knows to wake us.
+    s_parked.fetch_add(1, std::memory_order_relaxed);
+    while (state.exchange(2, std::memory_order_acquire) != 0) {
+        futex_wait(state, 2);
+    }
 }
 
 void SMP::Lock::unlock() {
-    m_mutex->m_lock.store(false, std::memory_order_release);
+    assert(m_owns_lock);
+    m_owns_lock = false;
+    if (m_mutex->m_lock.exchange(0, std::memory_order_release) == 2) {
+        futex_wake(m_mutex->m_lock);
+    }
 }
 
 SMP::Lock::~Lock() {
-    unlock();
+    // It may have been unlocked early.
+    if (m_owns_lock) {
+        unlock();
+    }
+}
+
+SMP::LockStats SMP::get_lock_stats() {
+    return {s_contended.load(), s_parked.load()};
+}
+
+void SMP::reset_lock_stats() {
+    s_contended = 0;
+    s_parked = 0;
 }
 
 int SMP::get_num_cpus() {
@@ -26,15 +26,25 @@
 namespace SMP {
     int get_num_cpus();
 
+    // Spins for a short while, then sleeps until the holder wakes it.
     class Mutex {
     public:
         Mutex();
         ~Mutex() = default;
         friend class Lock;
     private:
-        std::atomic<bool> m_lock;
+        // 0 unlocked, 1 locked, 2 locked with sleepers
+        std::atomic<int> m_lock;
     };
 
+    // How often locks had to wait, counted over all mutexes.
+    struct LockStats {
+        int contended;  // taken after spinning or sleeping
+        int parked;     // had to sleep
+    };
+    LockStats get_lock_stats();
+    void reset_lock_stats();
+
     class Lock {
     public:
         explicit Lock(Mutex & m);
@@ -43,6 +53,7 @@ namespace SMP {
         void unlock();
     private:
         Mutex * m_mutex;
+        bool m_owns_lock{false};
     };
 }
 
@@ -0,0 +1,88 @@
+/*
+    This file is part of Leela Zero.
+
+    Leela Zero is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Leela Zero is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Leela Zero.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "config.h"
+#include "TTable.h"
+
+#include <algorithm>
+
+TTable& TTable::get_TT(void) {
+    static TTable s_ttable;
+    return s_ttable;
+}
+
+TTable::TTable(int size) {
+    m_buckets.resize(size);
+}
+
+void TTable::clear() {
+    // Stripe by stripe, under the lock the stripe is used with.
+    for (auto i = size_t{0}; i < NUM_LOCKS; i++) {
+        LOCK(m_mutexes[i], lock);
+        for (auto j = i; j < m_buckets.size(); j += NUM_LOCKS) {
+            m_buckets[j] = TTEntry{};
+        }
+    }
+}
+
+SMP::Mutex& TTable::get_mutex(std::uint64_t hash) {
+    return m_mutexes[(hash % m_buckets.size()) % NUM_LOCKS];
+}
+
+TTEntry* TTable::lookup(std::uint64_t hash) {
+    auto index = static_cast<size_t>(hash % m_buckets.size());
+
+    if (m_buckets[index].m_hash == hash) {
+        return &m_buckets[index];
+    }
+
+    return nullptr;
+}
+
+void TTable::update(std::uint64_t hash,
+                    const UCTChildren& children, size_t idx) {
+    LOCK(get_mutex(hash), lock);
+
+    auto index = static_cast<size_t>(hash % m_buckets.size());
+    auto& entry = m_buckets[index];
+    auto visits = children.get_visits(idx);
+
+    // Don't let a path that knows less overwrite the entry.
+    if (entry.m_hash == hash && entry.m_visits > visits) {
+        return;
+    }
+
+    entry.m_hash = hash;
+    entry.m_visits = visits;
+    entry.m_eval_sum = children.get_blackevals(idx);
+}
+
+void TTable::sync(std::uint64_t hash, UCTChildren& children, size_t idx) {
+    LOCK(get_mutex(hash), lock);
+
+    auto entry = lookup(hash);
+    if (entry == nullptr) {
+        return;
+    }
+
+    // Only a child the search hasn't been to yet takes over the entry,
+    // the statistics of a visited child are updated concurrently.
+    if (entry->m_visits > 0) {
+        children.adopt_stats(idx, entry->m_visits, entry->m_eval_sum);
+    }
+}
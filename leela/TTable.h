@@ -0,0 +1,76 @@
+/*
+    This file is part of Leela Zero.
+
+    Leela Zero is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Leela Zero is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Leela Zero.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef TTABLE_H_INCLUDED
+#define TTABLE_H_INCLUDED
+
+#include "config.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "SMP.h"
+#include "UCTNode.h"
+
+class TTEntry {
+public:
+    TTEntry() = default;
+
+    std::uint64_t m_hash{0};
+    int m_visits{0};
+    double m_eval_sum{0.0};
+};
+
+/*
+    Statistics of positions reached through more than one move order.
+    The search tree stays a tree: move legality (superko) is still
+    decided per path, only the visits and evals of the children that
+    lead to the same position are shared.
+*/
+class TTable {
+public:
+    // return the global TT
+    static TTable& get_TT(void);
+
+    // Store the statistics of the child idx, which leads to
+    // the position with this hash.
+    void update(std::uint64_t hash, const UCTChildren& children, size_t idx);
+
+    // Take over the statistics of the position if the child
+    // hasn't been visited yet.
+    void sync(std::uint64_t hash, UCTChildren& children, size_t idx);
+
+    // The statistics are only valid for one komi, UCTSearch clears
+    // the table when a game starts or the komi changes.
+    void clear();
+
+private:
+    TTable(int size = 500000);  // ~ 12MB
+
+    // Stripes of buckets share a lock.
+    static constexpr auto NUM_LOCKS = size_t{256};
+
+    TTEntry* lookup(std::uint64_t hash);
+    SMP::Mutex& get_mutex(std::uint64_t hash);
+
+    std::vector<TTEntry> m_buckets;
+    std::array<SMP::Mutex, NUM_LOCKS> m_mutexes;
+};
+
+#endif
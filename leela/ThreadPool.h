@@ -24,82 +24,228 @@
     distribution.
 */
 
-#include <cstddef>
-#include <vector>
-#include <thread>
-#include <queue>
-#include <mutex>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
 #include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <limits>
 #include <memory>
-#include <future>
-#include <functional>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 namespace Utils {
 
+// A task is stored inline, so queueing one doesn't allocate. This
+// requires the callable to be small and trivially copyable, which
+// holds for lambdas capturing pointers, references and plain values.
+class Task {
+public:
+    static constexpr auto STORAGE_SIZE = std::size_t{56};
+
+    Task() = default;
+
+    template<class F>
+    explicit Task(F f) {
+        static_assert(sizeof(F) <= STORAGE_SIZE, "Task is too large.");
+        static_assert(alignof(F) <= alignof(std::max_align_t),
+                      "Task is overaligned.");
+        static_assert(std::is_trivially_copyable<F>::value,
+                      "Task must be trivially copyable.");
+        new (m_storage) F(f);
+        m_invoke = [](void* storage) { (*static_cast<F*>(storage))(); };
+    }
+
+    void operator()() {
+        m_invoke(m_storage);
+    }
+
+private:
+    alignas(std::max_align_t) unsigned char m_storage[STORAGE_SIZE];
+    void (*m_invoke)(void*){nullptr};
+};
+
+// The tasks of one worker. The owner takes the newest task, so
+// nested work stays in its cache, other workers steal the oldest.
+class WorkQueue {
+public:
+    static constexpr auto CAPACITY = std::size_t{256};
+
+    bool empty() const {
+        return m_size.load(std::memory_order_relaxed) == 0;
+    }
+
+    bool push(const Task& task) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_tail - m_head == CAPACITY) {
+            return false;
+        }
+        m_tasks[m_tail++ % CAPACITY] = task;
+        m_size++;
+        return true;
+    }
+
+    bool pop(Task& task) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_tail == m_head) {
+            return false;
+        }
+        task = m_tasks[--m_tail % CAPACITY];
+        m_size--;
+        return true;
+    }
+
+    bool steal(Task& task) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_tail == m_head) {
+            return false;
+        }
+        task = m_tasks[m_head++ % CAPACITY];
+        m_size--;
+        return true;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::array<Task, CAPACITY> m_tasks;
+    std::size_t m_head{0};
+    std::size_t m_tail{0};
+    std::atomic<std::size_t> m_size{0};
+};
+
 class ThreadPool {
 public:
     ThreadPool() = default;
     ~ThreadPool();
 
-    // create worker threads.  This version has no initializers.
-    void initialize(std::size_t);
+    // create worker threads, each with its own task queue. With
+    // pin_threads, worker i only runs on cpu i. Linux numbers the
+    // cores of a NUMA node consecutively, so workers stay together.
+    void initialize(std::size_t threads, bool pin_threads = false);
+
+    template<class F>
+    void add_task(F&& f);
 
-    // add an extra thread.  The thread calls initializer() before doing anything,
-    // so that the user can initialize per-thread data structures before doing work.
-    void add_thread(std::function<void()> initializer);
-    template<class F, class... Args>
-    auto add_task(F&& f, Args&&... args)
-        -> std::future<typename std::result_of<F(Args...)>::type>;
 private:
+    static constexpr auto NO_WORKER = std::numeric_limits<std::size_t>::max();
+    // Index of the worker running on this thread, if any.
+    static std::size_t& worker_index();
+    static void pin_thread(std::thread& thread, std::size_t cpu);
+
+    void worker(std::size_t index);
+    bool take_task(std::size_t index, Task& task);
+
+    std::vector<std::unique_ptr<WorkQueue>> m_queues;
     std::vector<std::thread> m_threads;
-    std::queue<std::function<void()>> m_tasks;
+    // Where to queue tasks coming from outside the pool.
+    std::atomic<std::size_t> m_next_queue{0};
+    std::atomic<std::size_t> m_queued{0};
 
+    // Idle workers sleep here.
     std::mutex m_mutex;
     std::condition_variable m_condvar;
     bool m_exit{false};
 };
 
-inline void ThreadPool::add_thread(std::function<void()> initializer) {
-    m_threads.emplace_back([this, initializer] {
-        initializer();
-        for (;;) {
-            std::function<void()> task;
-            {
-                std::unique_lock<std::mutex> lock(m_mutex);
-                m_condvar.wait(lock, [this]{ return m_exit || !m_tasks.empty(); });
-                if (m_exit && m_tasks.empty()) {
-                    return;
-                }
-                task = std::move(m_tasks.front());
-                m_tasks.pop();
-            }
-            task();
+inline std::size_t& ThreadPool::worker_index() {
+    static thread_local std::size_t index = NO_WORKER;
+    return index;
+}
+
+inline void ThreadPool::pin_thread(std::thread& thread, std::size_t cpu) {
+#ifdef __linux__
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(cpu, &cpuset);
+    pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set_t), &cpuset);
+#else
+    (void)thread;
+    (void)cpu;
+#endif
+}
+
+inline void ThreadPool::initialize(std::size_t threads, bool pin_threads) {
+    // All queues must exist before the first worker goes looking
+    // for work to steal.
+    for (std::size_t i = 0; i < threads; i++) {
+        m_queues.emplace_back(std::make_unique<WorkQueue>());
+    }
+    auto cpus = std::max(1u, std::thread::hardware_concurrency());
+    for (std::size_t i = 0; i < threads; i++) {
+        m_threads.emplace_back([this, i] { worker(i); });
+        if (pin_threads) {
+            pin_thread(m_threads.back(), i % cpus);
         }
-    });
+    }
+}
+
+inline bool ThreadPool::take_task(std::size_t index, Task& task) {
+    auto found = m_queues[index]->pop(task);
+    for (std::size_t i = 1; !found && i < m_queues.size(); i++) {
+        auto& victim = *m_queues[(index + i) % m_queues.size()];
+        found = !victim.empty() && victim.steal(task);
+    }
+    if (found) {
+        m_queued--;
+    }
+    return found;
 }
 
-inline void ThreadPool::initialize(size_t threads) {
-    for (size_t i = 0; i < threads; i++) {
-        add_thread( [](){} /* null function */);
+inline void ThreadPool::worker(std::size_t index) {
+    worker_index() = index;
+    for (;;) {
+        Task task;
+        if (take_task(index, task)) {
+            task();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condvar.wait(lock, [this]{ return m_exit || m_queued > 0; });
+        if (m_exit && m_queued == 0) {
+            return;
+        }
     }
 }
 
-template<class F, class... Args>
-auto ThreadPool::add_task(F&& f, Args&&... args)
-    -> std::future<typename std::result_of<F(Args...)>::type> {
-    using return_type = typename std::result_of<F(Args...)>::type;
+template<class F>
+void ThreadPool::add_task(F&& f) {
+    assert(!m_queues.empty());
+    auto task = Task(std::forward<F>(f));
 
-    auto task = std::make_shared< std::packaged_task<return_type()> >(
-        std::bind(std::forward<F>(f), std::forward<Args>(args)...)
-    );
+    // Workers queue on their own deque, others spread the tasks.
+    auto start = worker_index();
+    if (start >= m_queues.size()) {
+        start = m_next_queue++;
+    }
+    // Count the task before it can be taken, or a worker could
+    // decrement the counter first and wrap it around.
+    m_queued++;
+    for (std::size_t i = 0; ; i++) {
+        if (m_queues[(start + i) % m_queues.size()]->push(task)) {
+            break;
+        }
+        if (i % m_queues.size() == m_queues.size() - 1) {
+            // Everything is full, wait for the workers to catch up.
+            std::this_thread::yield();
+        }
+    }
 
-    std::future<return_type> res = task->get_future();
+    // Make sure a worker that is about to sleep sees the task.
     {
-        std::unique_lock<std::mutex> lock(m_mutex);
-        m_tasks.emplace([task](){(*task)();});
+        std::lock_guard<std::mutex> lock(m_mutex);
     }
     m_condvar.notify_one();
-    return res;
 }
 
 inline ThreadPool::~ThreadPool() {
@@ -116,20 +262,59 @@ inline ThreadPool::~ThreadPool() {
 class ThreadGroup {
 public:
     ThreadGroup(ThreadPool & pool) : m_pool(pool) {}
-    template<class F, class... Args>
-    void add_task(F&& f, Args&&... args) {
-        m_taskresults.emplace_back(
-            m_pool.add_task(std::forward<F>(f), std::forward<Args>(args)...)
-        );
+    ~ThreadGroup() {
+        // The tasks refer to us, so they must be done.
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condvar.wait(lock, [this]{ return m_pending == 0; });
+    }
+
+    template<class F>
+    void add_task(F&& f) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pending++;
+        }
+        auto fn = typename std::decay<F>::type(std::forward<F>(f));
+        m_pool.add_task([this, fn]() mutable {
+            try {
+                fn();
+            } catch (...) {
+                task_done(std::current_exception());
+                return;
+            }
+            task_done(nullptr);
+        });
     }
+
+    // Wait for all tasks and rethrow the first exception of any of them.
     void wait_all() {
-        for (auto && result: m_taskresults) {
-            result.get();
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condvar.wait(lock, [this]{ return m_pending == 0; });
+        if (m_exception) {
+            auto exception = m_exception;
+            m_exception = nullptr;
+            std::rethrow_exception(exception);
         }
     }
+
 private:
+    void task_done(std::exception_ptr exception) {
+        // Notify while holding the lock, the group can be gone
+        // as soon as the waiter gets it.
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (exception && !m_exception) {
+            m_exception = exception;
+        }
+        if (--m_pending == 0) {
+            m_condvar.notify_all();
+        }
+    }
+
     ThreadPool & m_pool;
-    std::vector<std::future<void>> m_taskresults;
+    std::mutex m_mutex;
+    std::condition_variable m_condvar;
+    std::size_t m_pending{0};
+    std::exception_ptr m_exception;
 };
 
 }
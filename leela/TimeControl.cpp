@@ -0,0 +1,155 @@
+/*
+    This file is part of Leela Zero.
+
+    Leela Zero is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Leela Zero is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Leela Zero.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "TimeControl.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+#include "FastBoard.h"
+#include "GTP.h"
+#include "Utils.h"
+
+using namespace Utils;
+
+TimeControl::TimeControl(int maintime, int byotime,
+                         int byostones, int byoperiods)
+    : m_maintime(maintime),
+      m_byotime(byotime),
+      m_byostones(byostones),
+      m_byoperiods(byoperiods) {
+
+    reset_clocks();
+}
+
+void TimeControl::reset_clocks() {
+    m_remaining_time.fill(m_maintime);
+    m_stones_left.fill(m_byostones);
+    m_periods_left.fill(m_byoperiods);
+    m_inbyo.fill(m_maintime <= 0);
+    // Now that byo-yomi status is set, add time
+    // back to our clocks
+    if (m_inbyo[0]) {
+        m_remaining_time.fill(m_byotime);
+    }
+}
+
+bool TimeControl::is_timed() const {
+    return m_maintime > 0 || m_byotime > 0;
+}
+
+void TimeControl::start(int color) {
+    m_times[color] = Time();
+}
+
+void TimeControl::stop(int color) {
+    Time stop;
+    int elapsed = Time::timediff_centis(m_times[color], stop);
+
+    assert(elapsed >= 0);
+
+    m_remaining_time[color] -= elapsed;
+
+    if (m_inbyo[color]) {
+        if (m_byostones) {
+            m_stones_left[color]--;
+        } else if (m_byoperiods) {
+            if (elapsed > m_byotime) {
+                m_periods_left[color]--;
+            }
+        }
+    }
+
+    /*
+        time up, entering byo yomi
+    */
+    if (!m_inbyo[color] && m_remaining_time[color] <= 0) {
+        m_remaining_time[color] = m_byotime;
+        m_stones_left[color] = m_byostones;
+        m_periods_left[color] = m_byoperiods;
+        m_inbyo[color] = true;
+    } else if (m_inbyo[color] && m_byostones && m_stones_left[color] <= 0) {
+        // reset byoyomi time and stones
+        m_remaining_time[color] = m_byotime;
+        m_stones_left[color] = m_byostones;
+    } else if (m_inbyo[color] && m_byoperiods) {
+        m_remaining_time[color] = m_byotime;
+    }
+}
+
+int TimeControl::max_time_for_move(int color, int movenum) const {
+    if (!is_timed()) {
+        return std::numeric_limits<int>::max();
+    }
+
+    // Assume the game lasts until about 2/3 of the board is
+    // filled, and always budget for some more moves of our own.
+    auto moves_remaining = std::max(30,
+        (FastBoard::BOARDSQ * 2 / 3 - movenum) / 2);
+    auto time_remaining = m_remaining_time[color];
+    auto extra_time_per_move = 0;
+
+    if (m_byotime != 0) {
+        if (m_inbyo[color]) {
+            if (m_byostones) {
+                // Canadian: spread the period over its stones.
+                moves_remaining = std::max(1, m_stones_left[color]);
+            } else {
+                // Japanese: each move may use a whole period.
+                time_remaining = 0;
+                extra_time_per_move = m_byotime;
+            }
+        } else if (m_byostones) {
+            // Main time is followed by overtime, so we
+            // can afford a little more per move.
+            extra_time_per_move = m_byotime / m_byostones;
+        } else if (m_byoperiods) {
+            extra_time_per_move = m_byotime;
+        }
+    }
+
+    // Keep a safety margin for network lag and move transmission.
+    auto base_time = std::max(time_remaining - cfg_lagbuffer_cs, 0)
+                     / moves_remaining;
+    auto inc_time = std::max(extra_time_per_move - cfg_lagbuffer_cs, 0);
+
+    return std::max(base_time + inc_time, 1);
+}
+
+void TimeControl::display_times() const {
+    for (auto color : {FastBoard::BLACK, FastBoard::WHITE}) {
+        auto rem = m_remaining_time[color] / 100;  /* centiseconds to seconds */
+        auto hours = rem / (60 * 60);
+        rem = rem % (60 * 60);
+        auto minutes = rem / 60;
+        auto seconds = rem % 60;
+        myprintf("%s time: %02d:%02d:%02d",
+                 color == FastBoard::BLACK ? "Black" : "White",
+                 hours, minutes, seconds);
+        if (m_inbyo[color]) {
+            if (m_byostones) {
+                myprintf(", %d stones left", m_stones_left[color]);
+            } else if (m_byoperiods) {
+                myprintf(", %d period(s) of %d seconds left",
+                         m_periods_left[color], m_byotime / 100);
+            }
+        }
+        myprintf("\n");
+    }
+}
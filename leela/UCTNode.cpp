@@ -22,12 +22,15 @@
 #include <cstdio>
 #include <cstdint>
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <functional>
 #include <iterator>
 #include <limits>
+#include <new>
 #include <numeric>
 #include <random>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -42,19 +45,255 @@
 
 using namespace Utils;
 
-UCTNode::UCTNode(int vertex, float score, float init_eval)
-    : m_move(vertex), m_score(score), m_init_eval(init_eval) {
+// Nodes and children live in a NodeArena, which never runs destructors.
+static_assert(std::is_trivially_destructible<UCTNode>::value,
+              "UCTNode must be trivially destructible");
+static_assert(std::is_trivially_destructible<UCTChildren>::value,
+              "UCTChildren must be trivially destructible");
+
+// A node has at most one child per vertex plus pass.
+static constexpr auto MAX_CHILDREN = FastBoard::BOARDSQ + 1;
+
+// Bytes taken by the arrays of count children, largest alignment first
+// so that every array is aligned.
+static size_t children_bytes(size_t count) {
+    return count * (sizeof(std::atomic<UCTNode*>)
+                    + sizeof(std::atomic<double>)
+                    + sizeof(std::atomic<int>)
+                    + sizeof(float)
+                    + sizeof(std::atomic<std::int16_t>)
+                    + sizeof(std::int16_t)
+                    + sizeof(std::atomic<bool>));
 }
 
-bool UCTNode::first_visit() const {
-    return m_visits == 0;
+UCTChildren* UCTChildren::create(NodeArena& arena, size_t count, float init_eval) {
+    assert(count <= MAX_CHILDREN);
+    auto mem = arena.allocate(sizeof(UCTChildren) + children_bytes(count));
+    return new (mem) UCTChildren(count, init_eval);
+}
+
+UCTChildren::UCTChildren(size_t count, float init_eval)
+    : m_count(static_cast<std::uint16_t>(count)),
+      m_capacity(static_cast<std::uint16_t>(count)),
+      m_init_eval(init_eval) {
+    for (auto i = size_t{0}; i < count; i++) {
+        new (&nodes()[i]) std::atomic<UCTNode*>(nullptr);
+        new (&blackevals()[i]) std::atomic<double>(0.0);
+        new (&visits()[i]) std::atomic<int>(0);
+        new (&scores()[i]) float(0.0f);
+        new (&virtual_losses()[i]) std::atomic<std::int16_t>(0);
+        new (&moves()[i]) std::int16_t(FastBoard::PASS);
+        new (&valids()[i]) std::atomic<bool>(true);
+    }
+}
+
+std::atomic<UCTNode*>* UCTChildren::nodes() const {
+    auto base = reinterpret_cast<const char*>(this + 1);
+    return reinterpret_cast<std::atomic<UCTNode*>*>(const_cast<char*>(base));
+}
+
+std::atomic<double>* UCTChildren::blackevals() const {
+    return reinterpret_cast<std::atomic<double>*>(nodes() + m_capacity);
+}
+
+std::atomic<int>* UCTChildren::visits() const {
+    return reinterpret_cast<std::atomic<int>*>(blackevals() + m_capacity);
+}
+
+float* UCTChildren::scores() const {
+    return reinterpret_cast<float*>(visits() + m_capacity);
+}
+
+std::atomic<std::int16_t>* UCTChildren::virtual_losses() const {
+    return reinterpret_cast<std::atomic<std::int16_t>*>(scores() + m_capacity);
+}
+
+std::int16_t* UCTChildren::moves() const {
+    return reinterpret_cast<std::int16_t*>(virtual_losses() + m_capacity);
+}
+
+std::atomic<bool>* UCTChildren::valids() const {
+    return reinterpret_cast<std::atomic<bool>*>(moves() + m_capacity);
+}
+
+size_t UCTChildren::size() const {
+    return m_count;
+}
+
+void UCTChildren::truncate(size_t count) {
+    assert(count <= m_count);
+    m_count = static_cast<std::uint16_t>(count);
+}
+
+int UCTChildren::get_move(size_t idx) const {
+    return moves()[idx];
+}
+
+float UCTChildren::get_score(size_t idx) const {
+    return scores()[idx];
+}
+
+void UCTChildren::set_score(size_t idx, float score) {
+    scores()[idx] = score;
+}
+
+int UCTChildren::get_visits(size_t idx) const {
+    return visits()[idx].load(std::memory_order_relaxed);
+}
+
+int UCTChildren::get_virtual_loss(size_t idx) const {
+    return virtual_losses()[idx].load(std::memory_order_relaxed);
+}
+
+double UCTChildren::get_blackevals(size_t idx) const {
+    return blackevals()[idx].load(std::memory_order_relaxed);
+}
+
+float UCTChildren::get_init_eval() const {
+    return m_init_eval;
+}
+
+float UCTChildren::get_eval(size_t idx, int tomove) const {
+    // Due to the use of atomic updates and virtual losses, it is
+    // possible for the visit count to change underneath us. Make sure
+    // to return a consistent result to the caller by caching the values.
+    auto virtual_loss = get_virtual_loss(idx);
+    auto visits = get_visits(idx) + virtual_loss;
+    if (visits > 0) {
+        auto blackeval = get_blackevals(idx);
+        if (tomove == FastBoard::WHITE) {
+            blackeval += static_cast<double>(virtual_loss);
+        }
+        auto score = static_cast<float>(blackeval / (double)visits);
+        if (tomove == FastBoard::WHITE) {
+            score = 1.0f - score;
+        }
+        return score;
+    } else {
+        // If a node has not been visited yet,
+        // the eval is that of the parent.
+        auto eval = m_init_eval;
+        if (tomove == FastBoard::WHITE) {
+            eval = 1.0f - eval;
+        }
+        return eval;
+    }
+}
+
+bool UCTChildren::valid(size_t idx) const {
+    return valids()[idx].load(std::memory_order_relaxed);
+}
+
+void UCTChildren::invalidate(size_t idx) {
+    valids()[idx] = false;
+}
+
+void UCTChildren::virtual_loss(size_t idx) {
+    virtual_losses()[idx] += UCTNode::VIRTUAL_LOSS_COUNT;
+}
+
+void UCTChildren::virtual_loss_undo(size_t idx) {
+    virtual_losses()[idx] -= UCTNode::VIRTUAL_LOSS_COUNT;
+}
+
+void UCTChildren::update(size_t idx, float eval) {
+    visits()[idx]++;
+    atomic_add(blackevals()[idx], (double)eval);
+}
+
+bool UCTChildren::adopt_stats(size_t idx, int visits, double blackevals) {
+    if (get_visits(idx) != 0) {
+        return false;
+    }
+    // The evals go in first, so whoever sees the visits sees them too.
+    // Concurrent update()s only add, so they can't get lost.
+    atomic_add(this->blackevals()[idx], blackevals);
+    auto expected = 0;
+    if (this->visits()[idx].compare_exchange_strong(expected, visits)) {
+        return true;
+    }
+    // The child got its own first visit in between.
+    atomic_add(this->blackevals()[idx], -blackevals);
+    return false;
+}
+
+UCTNode* UCTChildren::get_node(size_t idx) const {
+    return nodes()[idx].load(std::memory_order_acquire);
+}
+
+UCTNode* UCTChildren::get_or_create_node(size_t idx, NodeArena& arena) {
+    auto node = get_node(idx);
+    if (node) {
+        return node;
+    }
+    auto created = new (arena.allocate(sizeof(UCTNode))) UCTNode();
+    if (nodes()[idx].compare_exchange_strong(node, created,
+                                             std::memory_order_acq_rel)) {
+        return created;
+    }
+    // Somebody beat us to it, created stays unused in the arena.
+    return node;
+}
+
+void UCTChildren::permute(const std::vector<size_t>& order) {
+    assert(order.size() <= m_count);
+    auto node_tmp = std::vector<UCTNode*>{};
+    auto blackevals_tmp = std::vector<double>{};
+    auto visits_tmp = std::vector<int>{};
+    auto scores_tmp = std::vector<float>{};
+    auto virtual_losses_tmp = std::vector<std::int16_t>{};
+    auto moves_tmp = std::vector<std::int16_t>{};
+    auto valids_tmp = std::vector<bool>{};
+    for (auto idx : order) {
+        node_tmp.emplace_back(nodes()[idx]);
+        blackevals_tmp.emplace_back(blackevals()[idx]);
+        visits_tmp.emplace_back(visits()[idx]);
+        scores_tmp.emplace_back(scores()[idx]);
+        virtual_losses_tmp.emplace_back(virtual_losses()[idx]);
+        moves_tmp.emplace_back(moves()[idx]);
+        valids_tmp.emplace_back(valids()[idx]);
+    }
+    for (auto i = size_t{0}; i < order.size(); i++) {
+        nodes()[i] = node_tmp[i];
+        blackevals()[i] = blackevals_tmp[i];
+        visits()[i] = visits_tmp[i];
+        scores()[i] = scores_tmp[i];
+        virtual_losses()[i] = virtual_losses_tmp[i];
+        moves()[i] = moves_tmp[i];
+        valids()[i] = valids_tmp[i];
+    }
+}
+
+void UCTChildren::move_child_to(size_t idx, UCTChildren& dst, size_t dst_idx,
+                                NodeArena& arena) {
+    dst.blackevals()[dst_idx] = get_blackevals(idx);
+    dst.visits()[dst_idx] = get_visits(idx);
+    dst.scores()[dst_idx] = get_score(idx);
+    dst.virtual_losses()[dst_idx] = get_virtual_loss(idx);
+    dst.moves()[dst_idx] = moves()[idx];
+    dst.valids()[dst_idx] = valid(idx);
+
+    auto node = get_node(idx);
+    if (node) {
+        auto moved = new (arena.allocate(sizeof(UCTNode))) UCTNode(std::move(*node));
+        moved->move_children_to(arena);
+        node = moved;
+    }
+    dst.nodes()[dst_idx] = node;
+}
+
+UCTNode::UCTNode(UCTNode&& node)
+    : m_is_expanding(node.m_is_expanding),
+      m_has_children(node.m_has_children.load()),
+      m_children(node.m_children) {
 }
 
 SMP::Mutex& UCTNode::get_mutex() {
     return m_nodemutex;
 }
 
-bool UCTNode::create_children(std::atomic<int> & nodecount,
+bool UCTNode::create_children(NodeArena & arena,
+                              std::atomic<int> & nodecount,
                               GameState & state,
                               float & eval) {
     // check whether somebody beat us to it (atomic)
@@ -91,39 +330,58 @@ bool UCTNode::create_children(std::atomic<int> & nodecount,
     }
     eval = net_eval;
 
-    std::vector<Network::scored_node> nodelist;
-
-    auto legal_sum = 0.0f;
+    // Priors by vertex, pass goes last.
+    constexpr auto PASS_IDX = FastBoard::BOARDSQ;
+    std::array<float, FastBoard::BOARDSQ + 1> priors;
+    priors.fill(0.0f);
     for (const auto& node : raw_netlist.first) {
         auto vertex = node.second;
-        if (state.is_move_legal(to_move, vertex)) {
-            nodelist.emplace_back(node);
-            legal_sum += node.first;
-        }
+        priors[vertex == FastBoard::PASS ? PASS_IDX : vertex] = node.first;
+    }
+
+    // Mask out the illegal moves in one go, pass is always legal.
+    const auto legal = state.get_legal_moves(to_move);
+    std::array<float, FastBoard::BOARDSQ + 1> mask;
+    mask.fill(0.0f);
+    legal.for_each([&](int vertex) { mask[vertex] = 1.0f; });
+    mask[PASS_IDX] = 1.0f;
+
+    auto legal_sum = 0.0f;
+    for (auto i = size_t{0}; i < priors.size(); i++) {
+        priors[i] *= mask[i];
+        legal_sum += priors[i];
     }
 
     // If the sum is 0 or a denormal, then don't try to normalize.
     if (legal_sum > std::numeric_limits<float>::min()) {
         // re-normalize after removing illegal moves.
-        for (auto& node : nodelist) {
-            node.first /= legal_sum;
+        for (auto i = size_t{0}; i < priors.size(); i++) {
+            priors[i] /= legal_sum;
         }
     }
 
+    std::vector<Network::scored_node> nodelist;
+    nodelist.reserve(legal.count() + 1);
+    legal.for_each([&](int vertex) {
+        nodelist.emplace_back(priors[vertex], vertex);
+    });
+    nodelist.emplace_back(priors[PASS_IDX], FastBoard::PASS);
+
     // nodelist at least has a pass move
     // Use best to worst order, so highest go first
     std::stable_sort(rbegin(nodelist), rend(nodelist));
 
+    auto children = UCTChildren::create(arena, nodelist.size(), net_eval);
+    for (auto i = size_t{0}; i < nodelist.size(); i++) {
+        children->moves()[i] = static_cast<std::int16_t>(nodelist[i].second);
+        children->scores()[i] = nodelist[i].first;
+    }
+
     lock.lock();
 
-    m_children.reserve(nodelist.size());
-    for (const auto& node : nodelist) {
-        m_children.emplace_back(
-            std::make_unique<UCTNode>(node.second, node.first, net_eval)
-        );
-    }
+    m_children = children;
 
-    nodecount += m_children.size();
+    nodecount += nodelist.size();
     m_has_children = true;
 
     lock.unlock();
@@ -131,24 +389,27 @@ bool UCTNode::create_children(std::atomic<int> & nodecount,
     return true;
 }
 
-
 void UCTNode::kill_superkos(const FastState& state) {
-    for (auto& child : m_children) {
-        auto move = child->get_move();
-        if (move != FastBoard::PASS) {
-            if (state.superko_move(state.get_to_move(), move)) {
-                // Don't delete nodes for now, just mark them invalid.
-                child->invalidate();
-            }
+    if (!has_children()) {
+        return;
+    }
+    auto& children = get_children();
+    auto keep = std::vector<size_t>{};
+    for (auto i = size_t{0}; i < children.size(); i++) {
+        auto move = children.get_move(i);
+        if (!children.valid(i)) {
+            continue;
         }
+        if (move != FastBoard::PASS
+            && state.superko_move(state.get_to_move(), move)) {
+            continue;
+        }
+        keep.emplace_back(i);
     }
 
     // Now do the actual deletion.
-    m_children.erase(
-        std::remove_if(begin(m_children), end(m_children),
-                       [](const auto &child) { return !child->valid(); }),
-        end(m_children)
-    );
+    children.permute(keep);
+    children.truncate(keep.size());
 }
 
 float UCTNode::eval_state(GameState& state) {
@@ -167,7 +428,11 @@ float UCTNode::eval_state(GameState& state) {
 }
 
 void UCTNode::dirichlet_noise(float epsilon, float alpha) {
-    auto child_cnt = m_children.size();
+    if (!has_children()) {
+        return;
+    }
+    auto& children = get_children();
+    auto child_cnt = children.size();
 
     auto dirichlet_vector = std::vector<float>{};
     std::gamma_distribution<float> gamma(alpha, 1.0f);
@@ -188,20 +453,20 @@ void UCTNode::dirichlet_noise(float epsilon, float alpha) {
         v /= sample_sum;
     }
 
-    child_cnt = 0;
-    for (auto& child : m_children) {
-        auto score = child->get_score();
-        auto eta_a = dirichlet_vector[child_cnt++];
+    for (size_t i = 0; i < child_cnt; i++) {
+        auto score = children.get_score(i);
+        auto eta_a = dirichlet_vector[i];
         score = score * (1 - epsilon) + epsilon * eta_a;
-        child->set_score(score);
+        children.set_score(i, score);
     }
 }
 
 void UCTNode::randomize_first_proportionally() {
+    auto& children = get_children();
     auto accum = std::uint64_t{0};
     auto accum_vector = std::vector<decltype(accum)>{};
-    for (const auto& child : m_children) {
-        accum += child->get_visits();
+    for (auto i = size_t{0}; i < children.size(); i++) {
+        accum += children.get_visits(i);
         accum_vector.emplace_back(accum);
     }
 
@@ -219,205 +484,168 @@ void UCTNode::randomize_first_proportionally() {
         return;
     }
 
-    assert(m_children.size() >= index);
+    assert(children.size() >= index);
 
     // Now swap the child at index with the first child
-    std::iter_swap(begin(m_children), begin(m_children) + index);
-}
-
-int UCTNode::get_move() const {
-    return m_move;
-}
-
-void UCTNode::virtual_loss() {
-    m_virtual_loss += VIRTUAL_LOSS_COUNT;
-}
-
-void UCTNode::virtual_loss_undo() {
-    m_virtual_loss -= VIRTUAL_LOSS_COUNT;
-}
-
-void UCTNode::update(float eval) {
-    m_visits++;
-    accumulate_eval(eval);
+    auto order = std::vector<size_t>(children.size());
+    std::iota(begin(order), end(order), 0);
+    std::swap(order[0], order[index]);
+    children.permute(order);
 }
 
 bool UCTNode::has_children() const {
     return m_has_children;
 }
 
-float UCTNode::get_score() const {
-    return m_score;
-}
-
-void UCTNode::set_score(float score) {
-    m_score = score;
-}
-
-int UCTNode::get_visits() const {
-    return m_visits;
-}
-
-float UCTNode::get_eval(int tomove) const {
-    // Due to the use of atomic updates and virtual losses, it is
-    // possible for the visit count to change underneath us. Make sure
-    // to return a consistent result to the caller by caching the values.
-    auto virtual_loss = int{m_virtual_loss};
-    auto visits = get_visits() + virtual_loss;
-    if (visits > 0) {
-        auto blackeval = get_blackevals();
-        if (tomove == FastBoard::WHITE) {
-            blackeval += static_cast<double>(virtual_loss);
-        }
-        auto score = static_cast<float>(blackeval / (double)visits);
-        if (tomove == FastBoard::WHITE) {
-            score = 1.0f - score;
-        }
-        return score;
-    } else {
-        // If a node has not been visited yet,
-        // the eval is that of the parent.
-        auto eval = m_init_eval;
-        if (tomove == FastBoard::WHITE) {
-            eval = 1.0f - eval;
-        }
-        return eval;
+size_t UCTNode::uct_select_child(NodeArena& arena, int color) {
+    auto& children = get_children();
+    const auto count = children.size();
+    const auto init_eval = children.get_init_eval();
+    const auto white = (color == FastBoard::WHITE);
+
+    // Take a snapshot of the statistics first, so the scoring loop
+    // below works on plain arrays and can be vectorized.
+    std::array<float, MAX_CHILDREN> visits;
+    std::array<float, MAX_CHILDREN> virtual_losses;
+    std::array<float, MAX_CHILDREN> blackevals;
+    std::array<float, MAX_CHILDREN> scores;
+    std::array<float, MAX_CHILDREN> valids;
+    for (auto i = size_t{0}; i < count; i++) {
+        visits[i] = static_cast<float>(children.get_visits(i));
+        virtual_losses[i] = static_cast<float>(children.get_virtual_loss(i));
+        blackevals[i] = static_cast<float>(children.get_blackevals(i));
+        scores[i] = children.get_score(i);
+        valids[i] = children.valid(i) ? 1.0f : 0.0f;
     }
-}
-
-double UCTNode::get_blackevals() const {
-    return m_blackevals;
-}
-
-void UCTNode::accumulate_eval(float eval) {
-    atomic_add(m_blackevals, (double)eval);
-}
-
-UCTNode* UCTNode::uct_select_child(int color) {
-    UCTNode* best = nullptr;
-    auto best_value = -1000.0f;
-
-    LOCK(get_mutex(), lock);
 
     // Count parentvisits.
     // We do this manually to avoid issues with transpositions.
     auto total_visited_policy = 0.0f;
-    auto parentvisits = size_t{0};
-    for (const auto& child : m_children) {
-        if (child->valid()) {
-            parentvisits += child->get_visits();
-            if (child->get_visits() > 0) {
-                total_visited_policy += child->get_score();
-            }
-        }
+    auto parentvisits = 0.0f;
+    for (auto i = size_t{0}; i < count; i++) {
+        parentvisits += valids[i] * visits[i];
+        total_visited_policy += (valids[i] > 0.0f && visits[i] > 0.0f) ? scores[i] : 0.0f;
     }
 
-    auto numerator = static_cast<float>(std::sqrt((double)parentvisits));
+    auto numerator = std::sqrt(parentvisits);
     auto fpu_reduction = cfg_fpu_reduction * std::sqrt(total_visited_policy);
-
-    for (const auto& child : m_children) {
-        if (!child->valid()) {
-            continue;
-        }
-
-        auto winrate = child->get_eval(color);
-        if (child->get_visits() == 0) {
+    auto fpu_eval = (white ? 1.0f - init_eval : init_eval) - fpu_reduction;
+
+    std::array<float, MAX_CHILDREN> values;
+    for (auto i = size_t{0}; i < count; i++) {
+        // Virtual losses count as losses for the side to move.
+        auto total = visits[i] + virtual_losses[i];
+        auto blackeval = blackevals[i] + (white ? virtual_losses[i] : 0.0f);
+        auto winrate = blackeval / std::max(total, 1.0f);
+        winrate = white ? 1.0f - winrate : winrate;
+        if (visits[i] == 0.0f) {
             // First play urgency
-            winrate -= fpu_reduction;
+            winrate = (total == 0.0f) ? fpu_eval : winrate - fpu_reduction;
         }
-        auto psa = child->get_score();
-        auto denom = 1.0f + child->get_visits();
-        auto puct = cfg_puct * psa * (numerator / denom);
-        auto value = winrate + puct;
-        assert(value > -1000.0f);
-
-        if (value > best_value) {
-            best_value = value;
-            best = child.get();
+        auto puct = cfg_puct * scores[i] * (numerator / (1.0f + visits[i]));
+        values[i] = valids[i] > 0.0f ? winrate + puct : -1000.0f;
+    }
+
+    auto best = size_t{0};
+    auto best_value = -1000.0f;
+    for (auto i = size_t{0}; i < count; i++) {
+        if (values[i] > best_value) {
+            best_value = values[i];
+            best = i;
         }
     }
 
-    assert(best != nullptr);
+    assert(best_value > -1000.0f);
+    children.get_or_create_node(best, arena);
     return best;
 }
 
-class NodeComp : public std::binary_function<UCTNode::node_ptr_t&,
-                                             UCTNode::node_ptr_t&, bool> {
+class NodeComp : public std::binary_function<size_t, size_t, bool> {
 public:
-    NodeComp(int color) : m_color(color) {};
-    bool operator()(const UCTNode::node_ptr_t& a,
-                    const UCTNode::node_ptr_t& b) {
+    NodeComp(const UCTChildren& children, int color)
+        : m_children(children), m_color(color) {};
+    bool operator()(size_t a, size_t b) {
         // if visits are not same, sort on visits
-        if (a->get_visits() != b->get_visits()) {
-            return a->get_visits() < b->get_visits();
+        if (m_children.get_visits(a) != m_children.get_visits(b)) {
+            return m_children.get_visits(a) < m_children.get_visits(b);
         }
 
         // neither has visits, sort on prior score
-        if (a->get_visits() == 0) {
-            return a->get_score() < b->get_score();
+        if (m_children.get_visits(a) == 0) {
+            return m_children.get_score(a) < m_children.get_score(b);
         }
 
         // both have same non-zero number of visits
-        return a->get_eval(m_color) < b->get_eval(m_color);
+        return m_children.get_eval(a, m_color) < m_children.get_eval(b, m_color);
     }
 private:
+    const UCTChildren& m_children;
     int m_color;
 };
 
 void UCTNode::sort_children(int color) {
     LOCK(get_mutex(), lock);
-    std::stable_sort(rbegin(m_children), rend(m_children), NodeComp(color));
+    auto& children = get_children();
+    auto order = std::vector<size_t>(children.size());
+    std::iota(begin(order), end(order), 0);
+    std::stable_sort(rbegin(order), rend(order), NodeComp(children, color));
+    children.permute(order);
 }
 
-UCTNode& UCTNode::get_best_root_child(int color) {
+size_t UCTNode::get_best_root_child(int color) {
     LOCK(get_mutex(), lock);
-    assert(!m_children.empty());
+    auto& children = get_children();
+    assert(children.size() > 0);
 
-    return *(std::max_element(begin(m_children), end(m_children),
-                              NodeComp(color))->get());
+    auto order = std::vector<size_t>(children.size());
+    std::iota(begin(order), end(order), 0);
+    return *std::max_element(begin(order), end(order), NodeComp(children, color));
 }
 
-UCTNode* UCTNode::get_first_child() const {
-    if (m_children.empty()) {
-        return nullptr;
-    }
-    return m_children.front().get();
-}
-
-const std::vector<UCTNode::node_ptr_t>& UCTNode::get_children() const {
-    return m_children;
+UCTChildren& UCTNode::get_children() const {
+    assert(m_children != nullptr);
+    return *m_children;
 }
 
 size_t UCTNode::count_nodes() const {
     auto nodecount = size_t{0};
     if (m_has_children) {
-        nodecount += m_children.size();
-        for (auto& child : m_children) {
-            nodecount += child->count_nodes();
+        auto& children = get_children();
+        nodecount += children.size();
+        for (auto i = size_t{0}; i < children.size(); i++) {
+            auto node = children.get_node(i);
+            if (node) {
+                nodecount += node->count_nodes();
+            }
         }
     }
     return nodecount;
 }
 
 // Used to find new root in UCTSearch
-UCTNode::node_ptr_t UCTNode::find_child(const int move) {
+int UCTNode::find_child(const int move) const {
     if (m_has_children) {
-        for (auto& child : m_children) {
-            if (child->get_move() == move) {
-                return std::move(child);
+        auto& children = get_children();
+        for (auto i = size_t{0}; i < children.size(); i++) {
+            if (children.get_move(i) == move) {
+                return static_cast<int>(i);
             }
         }
     }
 
     // Can happen if we resigned or children are not expanded
-    return nullptr;
-}
-
-
-void UCTNode::invalidate() {
-    m_valid = false;
+    return -1;
 }
 
-bool UCTNode::valid() const {
-    return m_valid;
+void UCTNode::move_children_to(NodeArena& arena) {
+    if (!m_has_children) {
+        return;
+    }
+    auto& children = get_children();
+    auto moved = UCTChildren::create(arena, children.size(),
+                                     children.get_init_eval());
+    for (auto i = size_t{0}; i < children.size(); i++) {
+        children.move_child_to(i, *moved, i, arena);
+    }
+    m_children = moved;
 }
@@ -22,13 +22,80 @@
 #include "config.h"
 
 #include <atomic>
-#include <memory>
+#include <cstdint>
 #include <vector>
 
 #include "GameState.h"
 #include "Network.h"
+#include "NodeArena.h"
 #include "SMP.h"
 
+class UCTNode;
+
+// The children of a node. Every statistic is kept in its own array so
+// that uct_select_child can scan them linearly instead of visiting each
+// child. The arrays follow this header in the same NodeArena allocation.
+// The nodes the children lead to are only created when the search
+// first descends into them, most children never get there.
+class UCTChildren {
+public:
+    static UCTChildren* create(NodeArena& arena, size_t count, float init_eval);
+
+    size_t size() const;
+    // Drop the children past count.
+    void truncate(size_t count);
+
+    int get_move(size_t idx) const;
+    float get_score(size_t idx) const;
+    void set_score(size_t idx, float score);
+    int get_visits(size_t idx) const;
+    int get_virtual_loss(size_t idx) const;
+    double get_blackevals(size_t idx) const;
+    // Eval of the parent, which also is the eval of children
+    // that have not been visited yet.
+    float get_init_eval() const;
+    float get_eval(size_t idx, int tomove) const;
+    bool valid(size_t idx) const;
+    void invalidate(size_t idx);
+    void virtual_loss(size_t idx);
+    void virtual_loss_undo(size_t idx);
+    void update(size_t idx, float eval);
+    // Give a child that has no visits yet these statistics, see
+    // TTable::sync. False if an update() got there first.
+    bool adopt_stats(size_t idx, int visits, double blackevals);
+
+    // nullptr if the search never went here
+    UCTNode* get_node(size_t idx) const;
+    UCTNode* get_or_create_node(size_t idx, NodeArena& arena);
+
+    // Reorder the children so that the child at order[i] ends up at i.
+    // Only valid while no search is running.
+    void permute(const std::vector<size_t>& order);
+    // Copy the child at idx into slot dst_idx of dst, creating its node
+    // in arena and moving the subtree below it along. Only valid while
+    // no search is running.
+    void move_child_to(size_t idx, UCTChildren& dst, size_t dst_idx,
+                       NodeArena& arena);
+
+private:
+    friend class UCTNode;
+
+    UCTChildren(size_t count, float init_eval);
+
+    std::atomic<UCTNode*>* nodes() const;
+    std::atomic<double>* blackevals() const;
+    std::atomic<int>* visits() const;
+    float* scores() const;
+    std::atomic<std::int16_t>* virtual_losses() const;
+    std::int16_t* moves() const;
+    std::atomic<bool>* valids() const;
+
+    std::uint16_t m_count;
+    // Arrays are laid out for this many children.
+    std::uint16_t m_capacity;
+    float m_init_eval;
+};
+
 class UCTNode {
 public:
     // When we visit a node, add this amount of virtual losses
@@ -36,39 +103,29 @@ public:
     // search tree.
     static constexpr auto VIRTUAL_LOSS_COUNT = 3;
 
-    using node_ptr_t = std::unique_ptr<UCTNode>;
-
-    explicit UCTNode(int vertex, float score, float init_eval);
-    UCTNode() = delete;
+    UCTNode() = default;
     ~UCTNode() = default;
-    bool first_visit() const;
+    // Nodes get moved when compacting the tree. Only valid
+    // while no search is running.
+    UCTNode(UCTNode&& node);
     bool has_children() const;
-    bool create_children(std::atomic<int>& nodecount,
+    bool create_children(NodeArena& arena, std::atomic<int>& nodecount,
                          GameState& state, float& eval);
     float eval_state(GameState& state);
     void kill_superkos(const FastState& state);
-    void invalidate();
-    bool valid() const;
-    int get_move() const;
-    int get_visits() const;
-    float get_score() const;
-    void set_score(float score);
-    float get_eval(int tomove) const;
-    double get_blackevals() const;
-    void accumulate_eval(float eval);
-    void virtual_loss(void);
-    void virtual_loss_undo(void);
     void dirichlet_noise(float epsilon, float alpha);
     void randomize_first_proportionally();
-    void update(float eval);
 
-    UCTNode* uct_select_child(int color);
-    UCTNode* get_first_child() const;
-    const std::vector<node_ptr_t>& get_children() const;
+    // Returns the index of the selected child, its node has been created.
+    size_t uct_select_child(NodeArena& arena, int color);
+    UCTChildren& get_children() const;
     size_t count_nodes() const;
-    node_ptr_t find_child(const int move);
+    // Index of the child playing move, or -1 if there is none.
+    int find_child(const int move) const;
+    // Move all nodes below this one into arena.
+    void move_children_to(NodeArena& arena);
     void sort_children(int color);
-    UCTNode& get_best_root_child(int color);
+    size_t get_best_root_child(int color);
     SMP::Mutex& get_mutex();
 
 private:
@@ -76,25 +133,15 @@ private:
     // tens of millions of instances of these.  Please put extra caution
     // if you want to add/remove/reorder any variables here.
 
-    // Move
-    std::int16_t m_move;
-    // UCT
-    std::atomic<std::int16_t> m_virtual_loss{0};
-    std::atomic<int> m_visits{0};
-    // UCT eval
-    float m_score;
-    float m_init_eval;
-    std::atomic<double> m_blackevals{0};
-    // node alive (not superko)
-    std::atomic<bool> m_valid{true};
+    // The mutex goes first, so the flags fit into its padding.
+    SMP::Mutex m_nodemutex;
     // Is someone adding scores to this node?
     // We don't need to unset this.
     bool m_is_expanding{false};
-    SMP::Mutex m_nodemutex;
 
     // Tree data
     std::atomic<bool> m_has_children{false};
-    std::vector<node_ptr_t> m_children;
+    UCTChildren* m_children{nullptr};
 };
 
 #endif
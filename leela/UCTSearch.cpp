@@ -23,11 +23,14 @@
 #include <cstddef>
 #include <limits>
 #include <memory>
+#include <new>
 #include <type_traits>
 
 #include "FastBoard.h"
 #include "GTP.h"
 #include "GameState.h"
+#include "SMP.h"
+#include "TTable.h"
 #include "ThreadPool.h"
 #include "Timing.h"
 #include "Utils.h"
@@ -40,26 +43,74 @@ UCTSearch::UCTSearch(GameState& g)
     : m_rootstate(g) {
     set_playout_limit(cfg_max_playouts);
     set_visit_limit(cfg_max_visits);
-    m_root = std::make_unique<UCTNode>(FastBoard::PASS, 0.0f, 0.5f);
+    reset_root();
+    // A new game, the statistics of the last one don't apply.
+    if (cfg_transpositions) {
+        TTable::get_TT().clear();
+    }
 }
 
+UCTSearch::~UCTSearch() {
+    stop_ponder();
+}
 
-bool UCTSearch::play_simulation(const GameState& state, UCTNode* const startnode) {
+void UCTSearch::reset_root() {
+    m_arena = std::make_unique<NodeArena>();
+    m_root_stats = UCTChildren::create(*m_arena, 1, 0.5f);
+    m_root = m_root_stats->get_or_create_node(0, *m_arena);
+    m_nodes = 0;
+}
 
-    auto currstate = state;
+void UCTSearch::advance_root(int move) {
+    // Move the subtree we keep into a fresh arena, the rest
+    // of the tree is released along with the old arena.
+    auto arena = std::make_unique<NodeArena>();
+    auto idx = m_root->find_child(move);
+    if (idx >= 0) {
+        auto& children = m_root->get_children();
+        m_root_stats = UCTChildren::create(*arena, 1, children.get_init_eval());
+        children.move_child_to(idx, *m_root_stats, 0, *arena);
+    } else {
+        // Tree hasn't been expanded this far
+        m_root_stats = UCTChildren::create(*arena, 1, 0.5f);
+    }
+    m_root = m_root_stats->get_or_create_node(0, *arena);
+    m_arena = std::move(arena);
+
+    // Check how big our search tree (reused or new) is.
+    m_nodes = m_root->count_nodes();
+}
+
+
+bool UCTSearch::play_simulation(const GameState& state) {
+
+    // The statistics of a node are kept by its parent. The hash of
+    // the position is kept for the transposition table.
+    struct Visit {
+        UCTChildren* children;
+        size_t idx;
+        std::uint64_t hash;
+    };
+
+    // Every thread reuses its own scratch state and path, so once
+    // their vectors have grown to the search depth, walking the
+    // tree doesn't allocate.
+    static thread_local GameState currstate;
+    static thread_local std::vector<Visit> visited;
+    currstate = state;
+    visited.clear();
 
     bool result_valid = false;
     float result_eval;
 
-    std::vector<UCTNode*> visited;
-    
-    auto node = startnode;
+    auto stats = Visit{m_root_stats, size_t{0}, currstate.board.get_hash()};
+    auto node = m_root;
     auto color = currstate.get_to_move();
 
     while (true) {
 
-        node->virtual_loss();
-        visited.emplace_back(node);
+        stats.children->virtual_loss(stats.idx);
+        visited.emplace_back(stats);
 
         if (!node->has_children()) {
             if (currstate.get_passes() >= 2) {
@@ -74,7 +125,8 @@ bool UCTSearch::play_simulation(const GameState& state, UCTNode* const startnode
                 result_valid = true;
             } else if (m_nodes < MAX_TREE_SIZE) {
 
-                result_valid = node->create_children(m_nodes, currstate, result_eval);
+                result_valid = node->create_children(*m_arena, m_nodes,
+                                                     currstate, result_eval);
             } else {
                 result_eval = node->eval_state(currstate);
                 result_valid = true;
@@ -83,19 +135,21 @@ bool UCTSearch::play_simulation(const GameState& state, UCTNode* const startnode
         
         if (node->has_children() && !result_valid) {
 
-            auto next = node->uct_select_child(color);
-
-            if (next != nullptr) {
-                auto move = next->get_move();
+            auto& children = node->get_children();
+            auto next = node->uct_select_child(*m_arena, color);
+            auto move = children.get_move(next);
 
-                currstate.play_move(color, move);
-                if (move != FastBoard::PASS && currstate.superko()) {
-                    next->invalidate();
-                } else {
-                    node = next;
-                    color = currstate.get_to_move();
-                    continue;
+            currstate.play_move(color, move);
+            if (move != FastBoard::PASS && currstate.superko()) {
+                children.invalidate(next);
+            } else {
+                stats = Visit{&children, next, currstate.board.get_hash()};
+                if (cfg_transpositions) {
+                    TTable::get_TT().sync(stats.hash, children, next);
                 }
+                node = children.get_node(next);
+                color = currstate.get_to_move();
+                continue;
             }
         }
 
@@ -103,13 +157,17 @@ bool UCTSearch::play_simulation(const GameState& state, UCTNode* const startnode
     }
 
     for (auto it = visited.rbegin(); it != visited.rend(); it++) {
-    
-        auto node = *it;
+
+        auto& children = *it->children;
         if (result_valid) {
-            node->update(result_eval);
+            children.update(it->idx, result_eval);
+            // The root is only reached one way.
+            if (cfg_transpositions && it->children != m_root_stats) {
+                TTable::get_TT().update(it->hash, children, it->idx);
+            }
         }
-    
-        node->virtual_loss_undo();
+
+        children.virtual_loss_undo(it->idx);
     }
 
     if (result_valid) {
@@ -130,29 +188,33 @@ void UCTSearch::dump_stats(const FastState & state, UCTNode & parent) {
     parent.sort_children(color);
 
 
-    if (parent.get_first_child()->first_visit()) {
+    auto& children = parent.get_children();
+    if (children.get_visits(0) == 0) {
         return;
     }
 
     int movecount = 0;
-    for (const auto& node : parent.get_children()) {
+    for (auto i = size_t{0}; i < children.size(); i++) {
         // Always display at least two moves. In the case there is
         // only one move searched the user could get an idea why.
-        if (++movecount > 2 && !node->get_visits()) break;
+        if (++movecount > 2 && !children.get_visits(i)) break;
 
-        std::string tmp = FastBoard::move_to_text(node->get_move());
+        std::string tmp = FastBoard::move_to_text(children.get_move(i));
         std::string pvstring(tmp);
 
         myprintf("%4s -> %7d (V: %5.2f%%) (N: %5.2f%%) PV: ",
             tmp.c_str(),
-            node->get_visits(),
-            node->get_eval(color)*100.0f,
-            node->get_score() * 100.0f);
+            children.get_visits(i),
+            children.get_eval(i, color)*100.0f,
+            children.get_score(i) * 100.0f);
 
         auto tmpstate = state;
 
-        tmpstate.play_move(node->get_move());
-        pvstring += " " + get_pv(tmpstate, *node);
+        tmpstate.play_move(children.get_move(i));
+        auto node = children.get_node(i);
+        if (node) {
+            pvstring += " " + get_pv(tmpstate, *node);
+        }
 
         myprintf("%s\n", pvstring.c_str());
     }
@@ -165,7 +227,7 @@ bool UCTSearch::should_resign(float bestscore) {
         return false;
     }
 
-    const auto visits = m_root->get_visits();
+    const auto visits = m_root_stats->get_visits(0);
     if (visits < std::min(500, cfg_max_playouts))  {
         // low visits
         return false;
@@ -196,16 +258,17 @@ std::string UCTSearch::get_pv(FastState & state, UCTNode& parent) {
         return std::string();
     }
 
-    auto& best_child = parent.get_best_root_child(state.get_to_move());
-    if (best_child.first_visit()) {
+    auto& children = parent.get_children();
+    auto best_child = parent.get_best_root_child(state.get_to_move());
+    if (children.get_visits(best_child) == 0) {
         return std::string();
     }
-    auto best_move = best_child.get_move();
+    auto best_move = children.get_move(best_child);
     auto res = FastBoard::move_to_text(best_move);
 
     state.play_move(best_move);
 
-    auto next = get_pv(state, best_child);
+    auto next = get_pv(state, *children.get_node(best_child));
     if (!next.empty()) {
         res.append(" ").append(next);
     }
@@ -221,20 +284,57 @@ void UCTSearch::dump_analysis(int playouts) {
     int color = tempstate.board.get_to_move();
 
     std::string pvstring = get_pv(tempstate, *m_root);
-    float winrate = 100.0f * m_root->get_eval(color);
+    float winrate = 100.0f * m_root_stats->get_eval(0, color);
     myprintf("Playouts: %d, Win: %5.2f%%, PV: %s\n",
              playouts, winrate, pvstring.c_str());
 }
 
-bool UCTSearch::stop_thinking() const {
-    auto visits = m_root->get_visits();
+bool UCTSearch::stop_thinking(int elapsed_centis, int time_for_move) const {
+    auto visits = m_root_stats->get_visits(0);
     auto playouts = static_cast<int>(m_playouts);
     auto stop = playouts >= m_maxplayouts
-                || visits >= m_maxvisits;
+                || visits >= m_maxvisits
+                || elapsed_centis >= time_for_move
+                || !have_alternate_moves(elapsed_centis, time_for_move);
 
     return stop;
 }
 
+bool UCTSearch::have_alternate_moves(int elapsed_centis, int time_for_move) const {
+    // Only prune on the clock, playout limited searches (selfplay)
+    // need the full visit distribution.
+    if (time_for_move == std::numeric_limits<int>::max() || elapsed_centis <= 0) {
+        return true;
+    }
+    // A terminal root has nothing to compare.
+    if (!m_root->has_children()) {
+        return true;
+    }
+    // Estimate the playouts we can still do at the current speed.
+    auto remaining_centis = time_for_move - elapsed_centis;
+    auto remaining_playouts = static_cast<double>(m_playouts)
+                              * remaining_centis / elapsed_centis;
+
+    auto& children = m_root->get_children();
+    auto best = 0;
+    auto second = 0;
+    for (auto i = size_t{0}; i < children.size(); i++) {
+        if (!children.valid(i)) {
+            continue;
+        }
+        auto visits = children.get_visits(i);
+        if (visits > best) {
+            second = best;
+            best = visits;
+        } else if (visits > second) {
+            second = visits;
+        }
+    }
+    // The best move is decided if the runner-up can't catch up,
+    // even when it would get all remaining playouts.
+    return second + remaining_playouts >= best;
+}
+
 
 void UCTSearch::increment_playouts() {
     m_playouts++;
@@ -242,15 +342,26 @@ void UCTSearch::increment_playouts() {
 
 int UCTSearch::think(int color, std::vector<TimeStep>& steps) {
 
+    // Visits gathered while pondering stay in the tree.
+    stop_ponder();
+
     // Definition of m_playouts is playouts per search call.
     // So reset this count now.
     m_playouts = 0;
+    SMP::reset_lock_stats();
 
     // set side to move
     m_rootstate.board.set_to_move(color);
 
     // set up timing info
     Time start;
+    m_rootstate.start_clock(color);
+    auto time_for_move =
+        m_rootstate.get_timecontrol().max_time_for_move(color,
+                                                        m_rootstate.get_movenum());
+    if (m_rootstate.get_timecontrol().is_timed()) {
+        myprintf("Time budget: %.2fs\n", time_for_move / 100.0f);
+    }
 
     myprintf("Thinking ...\n");
 
@@ -258,10 +369,10 @@ int UCTSearch::think(int color, std::vector<TimeStep>& steps) {
     // play something legal and decent even in time trouble)
     float root_eval;
     if (!m_root->has_children()) {
-        m_root->create_children(m_nodes, m_rootstate, root_eval);
-        m_root->update(root_eval);
+        m_root->create_children(*m_arena, m_nodes, m_rootstate, root_eval);
+        m_root_stats->update(0, root_eval);
     } else {
-        root_eval = m_root->get_eval(color);
+        root_eval = m_root_stats->get_eval(0, color);
     }
     m_root->kill_superkos(m_rootstate);
     if (cfg_noise) {
@@ -277,17 +388,18 @@ int UCTSearch::think(int color, std::vector<TimeStep>& steps) {
     for (int i = 1; i < cpus; i++) {
         tg.add_task([this, &running] {
             do {
-                play_simulation(m_rootstate, m_root.get());
+                play_simulation(m_rootstate);
             } while(running);
         });
     }
 
     int last_update = 0;
+    int elapsed_centis;
     do {
-        play_simulation(m_rootstate, m_root.get());
+        play_simulation(m_rootstate);
 
         Time elapsed;
-        int elapsed_centis = Time::timediff_centis(start, elapsed);
+        elapsed_centis = Time::timediff_centis(start, elapsed);
 
         // output some stats every few seconds
         // check if we should still search
@@ -296,11 +408,15 @@ int UCTSearch::think(int color, std::vector<TimeStep>& steps) {
             dump_analysis(static_cast<int>(m_playouts));
         }
 
-    } while(!stop_thinking());
+    } while(!stop_thinking(elapsed_centis, time_for_move));
 
     // stop the search
     running = false;
     tg.wait_all();
+    m_rootstate.stop_clock(color);
+    if (m_rootstate.get_timecontrol().is_timed()) {
+        m_rootstate.get_timecontrol().display_times();
+    }
 
     if (!m_root->has_children()) {
         return FastBoard::PASS;
@@ -315,13 +431,14 @@ int UCTSearch::think(int color, std::vector<TimeStep>& steps) {
     step.to_move = m_rootstate.board.get_to_move();
     Network::gather_features(&m_rootstate, step.features);
 
-    step.probabilities.resize((19 * 19) + 1);
+    step.probabilities.resize(FastBoard::BOARDSQ + 1);
 
     // Get total visit amount. We count rather
     // than trust the root to avoid ttable issues.
+    auto& children = m_root->get_children();
     auto sum_visits = 0.0;
-    for (const auto& child : m_root->get_children()) {
-        sum_visits += child->get_visits();
+    for (auto i = size_t{0}; i < children.size(); i++) {
+        sum_visits += children.get_visits(i);
     }
 
     // In a terminal position (with 2 passes), we can have children, but we
@@ -330,13 +447,13 @@ int UCTSearch::think(int color, std::vector<TimeStep>& steps) {
     // visits, and we should not construct the (non-existent) probabilities.
     if (sum_visits > 0.0) {
 
-        for (const auto& child : m_root->get_children()) {
-            auto prob = static_cast<float>(child->get_visits() / sum_visits);
-            auto move = child->get_move();
+        for (auto i = size_t{0}; i < children.size(); i++) {
+            auto prob = static_cast<float>(children.get_visits(i) / sum_visits);
+            auto move = children.get_move(i);
             if (move != FastBoard::PASS) {
                 step.probabilities[move] = prob;
             } else {
-                step.probabilities[19 * 19] = prob;
+                step.probabilities[FastBoard::BOARDSQ] = prob;
             }
         }
 
@@ -344,14 +461,17 @@ int UCTSearch::think(int color, std::vector<TimeStep>& steps) {
     }
 
     Time elapsed;
-    int elapsed_centis = Time::timediff_centis(start, elapsed);
+    elapsed_centis = Time::timediff_centis(start, elapsed);
     if (elapsed_centis+1 > 0) {
-        myprintf("%d visits, %d nodes, %d playouts, %d n/s\n\n",
-                 m_root->get_visits(),
+        myprintf("%d visits, %d nodes, %d playouts, %d n/s\n",
+                 m_root_stats->get_visits(0),
                  static_cast<int>(m_nodes),
                  static_cast<int>(m_playouts),
                  (m_playouts * 100) / (elapsed_centis+1));
     }
+    auto lock_stats = SMP::get_lock_stats();
+    myprintf("Locks: %d contended, %d parked\n\n",
+             lock_stats.contended, lock_stats.parked);
 
     // get best mmove
 
@@ -365,11 +485,9 @@ int UCTSearch::think(int color, std::vector<TimeStep>& steps) {
         m_root->randomize_first_proportionally();
     }
 
-    auto first_child = m_root->get_first_child();
-    assert(first_child != nullptr);
-
-    auto bestmove = first_child->get_move();
-    auto bestscore = first_child->get_eval(color);
+    assert(children.size() > 0);
+    auto bestmove = children.get_move(0);
+    auto bestscore = children.get_eval(0, color);
 
     // if we aren't passing, should we consider resigning?
     if (bestmove != FastBoard::PASS) {
@@ -381,18 +499,68 @@ int UCTSearch::think(int color, std::vector<TimeStep>& steps) {
     }
 
     // advance move
-    m_rootstate.play_move(color, bestmove);
+    play_move(color, bestmove);
 
-    m_root = m_root->find_child(bestmove);
-    if (!m_root) {
-        // Tree hasn't been expanded this far
-        m_root = std::make_unique<UCTNode>(FastBoard::PASS, 0.0f, 0.5f);
+    return bestmove;
+}
+
+void UCTSearch::ponder() {
+    stop_ponder();
+
+    // Nothing left to search after the game ended.
+    if (m_rootstate.get_passes() >= 2
+        || m_rootstate.who_resigned() != FastBoard::EMPTY) {
+        return;
     }
 
-    // Check how big our search tree (reused or new) is.
-    m_nodes = m_root->count_nodes();
+    m_playouts = 0;
+    m_pondering = true;
+    m_ponder_threads = std::make_unique<ThreadGroup>(thread_pool);
+    for (int i = 0; i < cfg_num_threads; i++) {
+        m_ponder_threads->add_task([this] {
+            while (m_pondering) {
+                play_simulation(m_rootstate);
+            }
+        });
+    }
+}
 
-    return bestmove;
+void UCTSearch::stop_ponder() {
+    if (!m_ponder_threads) {
+        return;
+    }
+    m_pondering = false;
+    m_ponder_threads->wait_all();
+    m_ponder_threads.reset();
+
+    myprintf("Pondered %d playouts, %d visits at root.\n",
+             static_cast<int>(m_playouts), m_root_stats->get_visits(0));
+}
+
+void UCTSearch::play_move(int color, int move) {
+    stop_ponder();
+
+    // The tree only applies if it was searched with color to move.
+    auto tree_valid = (color == m_rootstate.get_to_move());
+    m_rootstate.play_move(color, move);
+    if (tree_valid) {
+        advance_root(move);
+    } else {
+        reset_root();
+    }
+}
+
+void UCTSearch::set_komi(float komi) {
+    stop_ponder();
+    if (komi == m_rootstate.get_komi()) {
+        return;
+    }
+    m_rootstate.set_komi(komi);
+    // All evaluations so far were for the old komi.
+    reset_root();
+    if (cfg_transpositions) {
+        TTable::get_TT().clear();
+    }
 }
 
 void UCTSearch::set_playout_limit(int playouts) {
@@ -26,8 +26,10 @@
 
 #include "FastBoard.h"
 #include "GameState.h"
+#include "NodeArena.h"
 #include "UCTNode.h"
 #include "Network.h"
+#include "ThreadPool.h"
 
 struct TimeStep {
     Network::NNPlanes features;
@@ -38,31 +40,51 @@ struct TimeStep {
 class UCTSearch {
 public:
     /*
-        Maximum size of the tree in memory. Nodes are about
-        48 bytes, so limit to ~1.2G on 32-bits and about 5.5G
-        on 64-bits.
+        Maximum size of the tree in memory, counted in children.
+        Each child takes 29 bytes in the arrays of its parent and gets
+        a 16 byte node only once it is visited, so about 2.9G on 64-bits
+        plus the nodes.
     */
     static constexpr auto MAX_TREE_SIZE =
         (sizeof(void*) == 4 ? 25'000'000 : 100'000'000);
 
     UCTSearch(GameState& g);
+    ~UCTSearch();
     int think(int color, std::vector<TimeStep>& steps);
+    // Keep searching the current position in the background,
+    // until the next call to think(), play_move() or stop_ponder().
+    void ponder();
+    void stop_ponder();
+    // Play a move on the root state, keeping the subtree below it.
+    void play_move(int color, int move);
+    // Start over if the komi changes.
+    void set_komi(float komi);
     void set_playout_limit(int playouts);
     void set_visit_limit(int visits);
     
 private:
-    bool play_simulation(const GameState& currstate, UCTNode* const node);
-    bool stop_thinking() const;
+    bool play_simulation(const GameState& currstate);
+    bool stop_thinking(int elapsed_centis, int time_for_move) const;
+    bool have_alternate_moves(int elapsed_centis, int time_for_move) const;
     void increment_playouts();
     void dump_stats(const FastState& state, UCTNode& parent);
     std::string get_pv(FastState& state, UCTNode& parent);
     void dump_analysis(int playouts);
     bool should_resign(float bestscore);
+    void advance_root(int move);
+    void reset_root();
 
     GameState & m_rootstate;
-    std::unique_ptr<UCTNode> m_root;
+    // All nodes of the tree live in m_arena.
+    std::unique_ptr<NodeArena> m_arena;
+    // The statistics of the root are kept like those of any other
+    // child, in a UCTChildren of its own.
+    UCTChildren* m_root_stats;
+    UCTNode* m_root;
     std::atomic<int> m_nodes{0};
     std::atomic<int> m_playouts{0};
+    std::atomic<bool> m_pondering{false};
+    std::unique_ptr<Utils::ThreadGroup> m_ponder_threads;
     
     int m_maxplayouts;
     int m_maxvisits;
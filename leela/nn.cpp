@@ -275,11 +275,11 @@ bool load_leela_weights(zero_net_type& net, const std::string& path) {
             add_bn_running_var(weights);
 
         } else if (linecount == plain_conv_wts + 4) {
-            add_fc_W(weights, 2*361, 362);
+            add_fc_W(weights, 2*zero::board_count, zero::board_moves);
 
         } else if (linecount == plain_conv_wts + 5) {
             // fc b
-            params.push_back({std::vector<int>{362}, weights});
+            params.push_back({std::vector<int>{zero::board_moves}, weights});
             
         } else if (linecount == plain_conv_wts + 6) {
             //conv_val_w = std::move(weights);
@@ -295,7 +295,7 @@ bool load_leela_weights(zero_net_type& net, const std::string& path) {
             add_bn_running_var(weights);
 
         } else if (linecount == plain_conv_wts + 10) {
-            add_fc_W(weights, 361, 256);
+            add_fc_W(weights, zero::board_count, 256);
 
         } else if (linecount == plain_conv_wts + 11) {
             //std::copy(begin(weights), end(weights), begin(ip1_val_b));
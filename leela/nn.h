@@ -5,25 +5,25 @@
 
 using namespace dlib;
 
-template <int N, long kernel, typename SUBNET> using bn_conv2d = affine<con<N,kernel,kernel,1,1,SUBNET>>;
-
+// Convolutions with their batch normalization, residual add and relu
+// fused in, see dlib::con_bn_.
 template <int N, typename SUBNET> 
-using block  = bn_conv2d<N,3,relu<bn_conv2d<N,3,SUBNET>>>;
+using block  = con_bn_add_relu<N,3,3,tag1,con_bn_relu<N,3,3,SUBNET>>;
 
 template <template <int,typename> class block, int N, typename SUBNET>
-using residual = add_prev1<block<N,tag1<SUBNET>>>;
+using residual = block<N,tag1<SUBNET>>;
 
 template <int classes, typename SUBNET>
-using policy_head = softmax<fc<classes, relu<bn_conv2d<2, 1, SUBNET>>>>;
+using policy_head = softmax<fc<classes, con_bn_relu<2,1,1, SUBNET>>>;
 
 template <typename SUBNET>
-using value_head = htan<fc<1, fc<256, relu<bn_conv2d<1, 1, SUBNET>>>>>;
+using value_head = htan<fc<1, fc<256, con_bn_relu<1,1,1, SUBNET>>>>;
 
 
 namespace zero {
 
 template <typename SUBNET> 
-using ares  = relu<residual<block, RESIDUAL_FILTERS, SUBNET>>;
+using ares  = residual<block, RESIDUAL_FILTERS, SUBNET>;
 
 using net_type = 
                             value_head<
@@ -31,9 +31,9 @@ using net_type =
                             policy_head<board_moves,
                             tag1<
                             repeat<RESIDUAL_BLOCKS, ares,
-                            relu<bn_conv2d<RESIDUAL_FILTERS,3,
+                            con_bn_relu<RESIDUAL_FILTERS,3,3,
                             input
-                            >>>>>>>;
+                            >>>>>>;
 
 }
 
@@ -47,24 +47,38 @@ public:
 
     zero_model();
 
+    // Copies share the (read-only) weights of the original but have their
+    // own activation buffers, so each copy can be run from its own thread.
+    zero_model(const zero_model&) = default;
+
     bool load_weights(const std::string& path);
 
-    std::pair<prediction, float> forward_net(double temperature = 1)  {
+    using result = std::pair<prediction, float>;
+
+    // Run every sample currently in the input buffer through the net.
+    std::vector<result> forward_batch(double temperature = 1)  {
 
         if (temperature != 1)
-            layer<7>(zero_net).layer_details().set_temprature(temperature);
+            layer<policy_layer>(zero_net).layer_details().set_temprature(temperature);
 
         auto& value_out = zero_net.forward(cached_input);
-        auto& out_tensor = layer<7>(zero_net).get_output();
+        auto& out_tensor = layer<policy_layer>(zero_net).get_output();
 
         auto src = out_tensor.host();
         auto data = value_out.host();
 
-        prediction dist;
-        std::copy(src, src+ zero::board_moves, std::back_inserter(dist)); 
-        float val = data[0];
+        std::vector<result> results;
+        results.reserve(cached_input.num_samples());
+        for (long n = 0; n < cached_input.num_samples(); n++) {
+            auto dist = src + n * zero::board_moves;
+            results.emplace_back(prediction(dist, dist + zero::board_moves), data[n]);
+        }
 
-        return {dist, val};
+        return results;
+    }
+
+    result forward_net(double temperature = 1)  {
+        return forward_batch(temperature).front();
     }
 
     template<typename FEATURE>
@@ -82,13 +96,16 @@ public:
         return forward_net(temperature);
     }
 
-    float* input_buffer() { 
+    float* input_buffer(int batch_size = 1) { 
         using namespace zero;
-        cached_input.set_size(1, input_channels, board_size, board_size);
+        cached_input.set_size(batch_size, input_channels, board_size, board_size);
         return cached_input.host_write_only(); 
     }
 
 private:
+    // the policy softmax, counting from the value head output
+    static constexpr size_t policy_layer = 5;
+
     zero_net_type zero_net;
     resizable_tensor cached_input;
 };
@@ -6,6 +6,7 @@
 // This file contains CPU implementations of the GPU based functions in cuda_dlib.h
 
 #include "cpu_dlib.h"
+#include "cpu_simd.h"
 #include "tensor_tools.h"
 
 namespace dlib
@@ -108,6 +109,24 @@ namespace dlib
 
             auto d = dest.host();
             auto s = src.host();
+            if (have_same_dimensions(src, dest))
+            {
+                simd::get_kernels().axpby(d, beta, s, alpha, dest.size());
+                return;
+            }
+            if (src.num_samples()==1 && src.k()==dest.k() && src.nr()==1 && src.nc()==1)
+            {
+                // a value per channel, like the biases of a layer
+                const size_t plane_size = dest.nr()*dest.nc();
+                const auto& kernels = simd::get_kernels();
+                for (long n = 0; n < dest.num_samples(); ++n)
+                {
+                    for (long k = 0; k < dest.k(); ++k, d += plane_size)
+                        kernels.scale_shift(d, d, beta, alpha*s[k], plane_size);
+                }
+                return;
+            }
+
             for (long n = 0; n < dest.num_samples(); ++n)
             {
                 const auto sn = src.num_samples()==1 ? 0:n;
@@ -146,8 +165,7 @@ namespace dlib
             if (have_same_dimensions(dest, src1) &&
                 have_same_dimensions(dest, src2))
             {
-                for (size_t i = 0; i < dest.size(); ++i)
-                    d[i] = s1[i] + s2[i];
+                simd::get_kernels().add(d, s1, s2, dest.size());
                 return;
             }
 
@@ -311,17 +329,15 @@ namespace dlib
             auto s = src.host();
             const auto a = A.host();
             const auto b = B.host();
+            const size_t plane_size = dest.nr()*dest.nc();
+            const auto& kernels = simd::get_kernels();
             for (long n = 0; n < dest.num_samples(); ++n)
             {
                 for (long k = 0; k < dest.k(); ++k)
                 {
-                    for (long r = 0; r < dest.nr(); ++r)
-                    {
-                        for (long c = 0; c < dest.nc(); ++c)
-                        {
-                            *d++ = a[k]*(*s++) + b[k];
-                        }
-                    }
+                    kernels.scale_shift(d, s, a[k], b[k], plane_size);
+                    d += plane_size;
+                    s += plane_size;
                 }
             }
         }
@@ -399,6 +415,15 @@ namespace dlib
             const auto d = dest.host();
             const auto s = src.host();
 
+            // One distribution per sample, stored contiguously.
+            if (num_locations == 1)
+            {
+                const auto& kernels = simd::get_kernels();
+                for (long n = 0; n < src.num_samples(); ++n)
+                    kernels.softmax(d + num_channels*n, s + num_channels*n, num_channels);
+                return;
+            }
+
             // Note that we subtract out the max values in each channel before applying
             // exp() to avoid numeric overflow in the subsequent computations.  Doing this
             // doesn't change the resulting output, it just makes it more numerically
@@ -459,7 +484,8 @@ namespace dlib
             const tensor& src
         )
         {
-            dest = lowerbound(mat(src), 0);
+            DLIB_CASSERT(have_same_dimensions(dest,src));
+            simd::get_kernels().relu(dest.host(), src.host(), dest.size());
         }
 
     // ----------------------------------------------------------------------------------------
@@ -489,10 +515,8 @@ namespace dlib
             const tensor& src
         )
         {
-            const auto d = dest.host();
-            const auto s = src.host();
-            for (size_t i = 0; i < src.size(); ++i)
-                d[i] = std::tanh(s[i]);
+            DLIB_CASSERT(have_same_dimensions(dest,src));
+            simd::get_kernels().tanh(dest.host(), src.host(), src.size());
         }
 
 
@@ -657,8 +681,64 @@ namespace dlib
     // ------------------------------------------------------------------------------------
     // ------------------------------------------------------------------------------------
 
+        namespace
+        {
+            // C = A*B, or C += A*B if accumulate, for row major A (M x K),
+            // B (K x N) and C (M x N)
+            void sgemm (
+                const bool accumulate,
+                float* C,
+                const float* A,
+                const float* B,
+                long M,
+                long N,
+                long K
+            )
+            {
+#ifdef DLIB_USE_BLAS
+                using namespace blas_bindings;
+                cblas_gemm(CblasRowMajor, CblasNoTrans, CblasNoTrans,
+                           M, N, K, 1, A, K, B, N, accumulate ? 1 : 0, C, N);
+#else
+                if (accumulate)
+                    set_ptrm(C, M, N) += mat(A, M, K)*mat(B, K, N);
+                else
+                    set_ptrm(C, M, N) = mat(A, M, K)*mat(B, K, N);
+#endif
+            }
+
+            // output = relu(value + biases[k] + residual), the
+            // epilogue of the fused convolutions
+            inline float conv_epilogue (
+                float value,
+                const float* biases,
+                long k,
+                const float* residual,
+                size_t idx,
+                bool relu
+            )
+            {
+                if (biases)
+                    value += biases[k];
+                if (residual)
+                    value += residual[idx];
+                if (relu && value < 0)
+                    value = 0;
+                return value;
+            }
+        }
+
+        /*
+            Unrolls the n-th sample of data into the columns n*P to (n+1)*P of
+            cols, a matrix with a row per filter tap (channel, filter row, filter
+            column), a column per output position of every sample and row stride
+            ld.  Then the convolution of the whole batch is filters*cols.  For
+            every tap the output columns that read from inside the image are
+            worked out up front, so the copy loops don't test the border.
+        */
         void img2col(
-            matrix<float>& output,
+            float* cols,
+            long ld,
             const tensor& data,
             long n,
             long filter_nr,
@@ -669,41 +749,48 @@ namespace dlib
             long padding_x
         )
         {
-            const auto d = data.host() + data.k()*data.nr()*data.nc()*n;
-            const rectangle boundary = rectangle(0, 0, data.nc()-1, data.nr()-1);
-
-            const long out_nr = 1+(data.nr()+2*padding_y-filter_nr)/stride_y;
-            const long out_nc = 1+(data.nc()+2*padding_x-filter_nc)/stride_x;
-
-            output.set_size(out_nr*out_nc, 
-                            data.k()*filter_nr*filter_nc);
-            DLIB_CASSERT(output.size() != 0);
-            float* t = &output(0,0);
-
-            // now fill in the Toeplitz output matrix for the n-th sample in data.  
-            size_t cnt = 0;
-            const long max_r = data.nr() + padding_y-(filter_nr-1);
-            const long max_c = data.nc() + padding_x-(filter_nc-1);
-            for (long r = -padding_y; r < max_r; r+=stride_y)
+            const long nr = data.nr();
+            const long nc = data.nc();
+            const auto d = data.host() + data.k()*nr*nc*n;
+
+            const long out_nr = 1+(nr+2*padding_y-filter_nr)/stride_y;
+            const long out_nc = 1+(nc+2*padding_x-filter_nc)/stride_x;
+            cols += n*out_nr*out_nc;
+
+            for (long k = 0; k < data.k(); ++k)
             {
-                for (long c = -padding_x; c < max_c; c+=stride_x)
+                const auto plane = d + k*nr*nc;
+                for (long y = 0; y < filter_nr; ++y)
                 {
-                    for (long k = 0; k < data.k(); ++k)
+                    for (long x = 0; x < filter_nc; ++x, cols += ld)
                     {
-                        for (long y = 0; y < filter_nr; ++y)
+                        // output columns c with 0 <= c*stride_x - padding_x + x < nc
+                        const long first = std::min(out_nc,
+                            (std::max(0L, padding_x - x) + stride_x - 1)/stride_x);
+                        const long last = std::max(first, std::min(out_nc,
+                            (nc - 1 + padding_x - x)/stride_x + 1));
+
+                        auto row = cols;
+                        for (long r = 0; r < out_nr; ++r, row += out_nc)
                         {
-                            for (long x = 0; x < filter_nc; ++x)
+                            const long yy = r*stride_y - padding_y + y;
+                            if (yy < 0 || yy >= nr)
+                            {
+                                std::fill(row, row + out_nc, 0.0f);
+                                continue;
+                            }
+                            const auto src = plane + yy*nc - padding_x + x;
+                            std::fill(row, row + first, 0.0f);
+                            if (stride_x == 1)
+                            {
+                                std::copy(src + first, src + last, row + first);
+                            }
+                            else
                             {
-                                DLIB_ASSERT(cnt < output.size());
-                                long xx = c+x;
-                                long yy = r+y;
-                                if (boundary.contains(xx,yy))
-                                    *t = d[(k*data.nr() + yy)*data.nc() + xx];
-                                else
-                                    *t = 0;
-                                ++t;
-                                ++cnt;
+                                for (long c = first; c < last; ++c)
+                                    row[c] = src[c*stride_x];
                             }
+                            std::fill(row + last, row + out_nc, 0.0f);
                         }
                     }
                 }
@@ -731,6 +818,36 @@ namespace dlib
             const tensor& data,
             const tensor& filters
         )
+        {
+            convolve(add_to_output, output, data, filters, nullptr, nullptr, false);
+        }
+
+        void tensor_conv::operator() (
+            resizable_tensor& output,
+            const tensor& data,
+            const tensor& filters,
+            const tensor* biases,
+            const tensor* residual,
+            const bool relu
+        )
+        {
+            DLIB_CASSERT(last_stride_y > 0 && last_stride_x > 0, "You must call setup() before calling this function.");
+            output.set_size(data.num_samples(),
+                            filters.num_samples(),
+                            1+(data.nr()+2*last_padding_y-filters.nr())/last_stride_y,
+                            1+(data.nc()+2*last_padding_x-filters.nc())/last_stride_x);
+            convolve(false, output, data, filters, biases, residual, relu);
+        }
+
+        void tensor_conv::convolve (
+            const bool add_to_output,
+            tensor& output,
+            const tensor& data,
+            const tensor& filters,
+            const tensor* biases,
+            const tensor* residual,
+            const bool relu
+        )
         {
             DLIB_CASSERT(is_same_object(output,data) == false);
             DLIB_CASSERT(is_same_object(output,filters) == false);
@@ -745,17 +862,255 @@ namespace dlib
             DLIB_CASSERT(output.k() == filters.num_samples());
             DLIB_CASSERT(output.nr() == 1+(data.nr()+2*last_padding_y-filters.nr())/last_stride_y);
             DLIB_CASSERT(output.nc() == 1+(data.nc()+2*last_padding_x-filters.nc())/last_stride_x);
+            DLIB_CASSERT(!biases || biases->size() == (size_t)output.k());
+            DLIB_CASSERT(!residual || have_same_dimensions(*residual, output));
+
+            const long N = data.num_samples();
+            const long K = filters.num_samples();
+            const long taps = filters.k()*filters.nr()*filters.nc();
+            const long P = output.nr()*output.nc();
+            // With 1x1 filters every sample already is a taps x P matrix and
+            // is multiplied straight into its place in the output.
+            const bool direct = is_pointwise(filters);
+            const bool in_place = direct || N == 1;
+            // Only grow, so after the first call this doesn't allocate.
+            if (!direct)
+                img2col_buffer.set_size(taps, N*P);
+            if (!in_place)
+                conv_products.set_size(K, N*P);
+
+            const auto out = add_to_output || in_place ? output.host() : output.host_write_only();
+            if (direct)
+            {
+                const auto in = data.host();
+                for (long n = 0; n < N; ++n)
+                    sgemm(add_to_output, out + n*K*P, filters.host(), in + n*taps*P, K, P, taps);
+            }
+            else
+            {
+                // Otherwise one taps x N*P matrix for the whole batch, so there
+                // is a single matrix product per layer however many samples
+                // there are.
+                const auto cols = img2col_buffer.host_write_only();
+                for (long n = 0; n < N; ++n)
+                {
+                    img2col(cols, N*P, data, n, filters.nr(), filters.nc(),
+                            last_stride_y, last_stride_x, last_padding_y, last_padding_x);
+                }
+
+                // The product is K x N*P but the output is N x K x P, so with
+                // more than one sample it goes through conv_products and is
+                // moved into place along with the epilogue.
+                if (N == 1)
+                    sgemm(add_to_output, out, filters.host(), cols, K, P, taps);
+                else
+                    sgemm(false, conv_products.host_write_only(), filters.host(), cols, K, N*P, taps);
+            }
 
+            if (in_place && !biases && !residual && !relu)
+                return;
 
-            matrix<float> temp;
-            for (long n = 0; n < data.num_samples(); ++n)
+            const auto products = in_place ? nullptr : conv_products.host();
+            const bool accumulate = add_to_output && !in_place;
+            const auto b = biases ? biases->host() : nullptr;
+            const auto res = residual ? residual->host() : nullptr;
+            for (long n = 0; n < N; ++n)
             {
-                img2col(temp, data, n, filters.nr(), filters.nc(), last_stride_y, last_stride_x, last_padding_y, last_padding_x);
+                for (long k = 0; k < K; ++k)
+                {
+                    const size_t plane = (n*K + k)*P;
+                    const auto src = in_place ? out + plane : products + k*N*P + n*P;
+                    for (long i = 0; i < P; ++i)
+                    {
+                        const float v = accumulate ? src[i] + out[plane + i] : src[i];
+                        out[plane + i] = conv_epilogue(v, b, k, res, plane + i, relu);
+                    }
+                }
+            }
+        }
 
-                if (add_to_output)
-                    output.add_to_sample(n, mat(filters)*trans(temp));
-                else 
-                    output.set_sample(n, mat(filters)*trans(temp));
+    // ------------------------------------------------------------------------------------
+
+        void winograd_transform_filters (
+            resizable_tensor& dest,
+            const tensor& filters
+        )
+        {
+            DLIB_CASSERT(filters.nr() == 3 && filters.nc() == 3);
+
+            // dest(xi, k, c) = (G g G^T)[xi] for the filter g of output k and input c
+            const long K = filters.num_samples();
+            const long C = filters.k();
+            dest.set_size(WINOGRAD_TILE, K, C);
+
+            const auto f = filters.host();
+            const auto u = dest.host_write_only();
+            for (long k = 0; k < K; ++k)
+            {
+                for (long c = 0; c < C; ++c)
+                {
+                    const auto g = f + (k*C + c)*9;
+
+                    // G g, 4x3
+                    float t[4][3];
+                    for (long x = 0; x < 3; ++x)
+                    {
+                        t[0][x] = g[x];
+                        t[1][x] = 0.5f*(g[x] + g[3+x] + g[6+x]);
+                        t[2][x] = 0.5f*(g[x] - g[3+x] + g[6+x]);
+                        t[3][x] = g[6+x];
+                    }
+
+                    // (G g) G^T, 4x4
+                    for (long y = 0; y < 4; ++y)
+                    {
+                        const float v[4] = {
+                            t[y][0],
+                            0.5f*(t[y][0] + t[y][1] + t[y][2]),
+                            0.5f*(t[y][0] - t[y][1] + t[y][2]),
+                            t[y][2]
+                        };
+                        for (long x = 0; x < 4; ++x)
+                            u[((y*4 + x)*K + k)*C + c] = v[x];
+                    }
+                }
+            }
+        }
+
+        void tensor_conv::winograd (
+            resizable_tensor& output,
+            const tensor& data,
+            const tensor& transformed_filters,
+            const tensor* biases,
+            const tensor* residual,
+            const bool relu
+        )
+        {
+            DLIB_CASSERT(last_stride_y == 1 && last_stride_x == 1);
+            DLIB_CASSERT(last_padding_y == 1 && last_padding_x == 1);
+            DLIB_CASSERT(transformed_filters.num_samples() == WINOGRAD_TILE);
+            DLIB_CASSERT(transformed_filters.nr() == data.k());
+
+            const long N = data.num_samples();
+            const long C = data.k();
+            const long K = transformed_filters.k();
+            const long H = data.nr();
+            const long W = data.nc();
+            const long tiles_y = (H + 1)/2;
+            const long tiles_x = (W + 1)/2;
+            // all tiles of all samples go through one matrix product
+            const long P = N*tiles_y*tiles_x;
+
+            output.set_size(N, K, H, W);
+            DLIB_CASSERT(!biases || biases->size() == (size_t)K);
+            DLIB_CASSERT(!residual || have_same_dimensions(*residual, output));
+            winograd_data.set_size(WINOGRAD_TILE, C, P);
+            winograd_products.set_size(WINOGRAD_TILE, K, P);
+
+            // V = B^T d B for every 4x4 input tile d, which overlap by 2
+            const auto in = data.host();
+            const auto V = winograd_data.host_write_only();
+            for (long n = 0; n < N; ++n)
+            {
+                for (long c = 0; c < C; ++c)
+                {
+                    const auto plane = in + (n*C + c)*H*W;
+                    for (long ty = 0; ty < tiles_y; ++ty)
+                    {
+                        for (long tx = 0; tx < tiles_x; ++tx)
+                        {
+                            float d[4][4];
+                            for (long y = 0; y < 4; ++y)
+                            {
+                                const long yy = 2*ty + y - 1;
+                                for (long x = 0; x < 4; ++x)
+                                {
+                                    const long xx = 2*tx + x - 1;
+                                    d[y][x] = (yy >= 0 && yy < H && xx >= 0 && xx < W) ?
+                                        plane[yy*W + xx] : 0;
+                                }
+                            }
+
+                            float t[4][4];
+                            for (long x = 0; x < 4; ++x)
+                            {
+                                t[0][x] = d[0][x] - d[2][x];
+                                t[1][x] = d[1][x] + d[2][x];
+                                t[2][x] = d[2][x] - d[1][x];
+                                t[3][x] = d[1][x] - d[3][x];
+                            }
+
+                            const long p = (n*tiles_y + ty)*tiles_x + tx;
+                            for (long y = 0; y < 4; ++y)
+                            {
+                                const float v[4] = {
+                                    t[y][0] - t[y][2],
+                                    t[y][1] + t[y][2],
+                                    t[y][2] - t[y][1],
+                                    t[y][1] - t[y][3]
+                                };
+                                for (long x = 0; x < 4; ++x)
+                                    V[((y*4 + x)*C + c)*P + p] = v[x];
+                            }
+                        }
+                    }
+                }
+            }
+
+            // M[xi] = U[xi] V[xi], one K x C by C x P product per tile element
+            const auto U = transformed_filters.host();
+            const auto M = winograd_products.host_write_only();
+            for (long xi = 0; xi < WINOGRAD_TILE; ++xi)
+            {
+                sgemm(false, M + xi*K*P, U + xi*K*C, V + xi*C*P, K, P, C);
+            }
+
+            // Y = A^T m A gives the 2x2 output tile, cut off at the border
+            const auto b = biases ? biases->host() : nullptr;
+            const auto res = residual ? residual->host() : nullptr;
+            const auto out = output.host_write_only();
+            for (long n = 0; n < N; ++n)
+            {
+                for (long k = 0; k < K; ++k)
+                {
+                    const size_t plane = (n*K + k)*H*W;
+                    for (long ty = 0; ty < tiles_y; ++ty)
+                    {
+                        for (long tx = 0; tx < tiles_x; ++tx)
+                        {
+                            const long p = (n*tiles_y + ty)*tiles_x + tx;
+                            float m[4][4];
+                            for (long xi = 0; xi < WINOGRAD_TILE; ++xi)
+                                m[xi/4][xi%4] = M[(xi*K + k)*P + p];
+
+                            float t[2][4];
+                            for (long x = 0; x < 4; ++x)
+                            {
+                                t[0][x] = m[0][x] + m[1][x] + m[2][x];
+                                t[1][x] = m[1][x] - m[2][x] - m[3][x];
+                            }
+
+                            for (long y = 0; y < 2; ++y)
+                            {
+                                const long yy = 2*ty + y;
+                                if (yy >= H)
+                                    break;
+                                const float v[2] = {
+                                    t[y][0] + t[y][1] + t[y][2],
+                                    t[y][1] - t[y][2] - t[y][3]
+                                };
+                                for (long x = 0; x < 2; ++x)
+                                {
+                                    const long xx = 2*tx + x;
+                                    if (xx >= W)
+                                        break;
+                                    const size_t idx = plane + yy*W + xx;
+                                    out[idx] = conv_epilogue(v[x], b, k, res, idx, relu);
+                                }
+                            }
+                        }
+                    }
+                }
             }
         }
 
@@ -787,8 +1142,7 @@ namespace dlib
             {
                 if (add_to)
                 {
-                    for (size_t j = 0; j < block_size; ++j)
-                        dest_p[j] += src_p[j];
+                    simd::get_kernels().add(dest_p, dest_p, src_p, block_size);
                 }
                 else
                 {
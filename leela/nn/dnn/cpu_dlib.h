@@ -214,14 +214,73 @@ namespace dlib
                 const tensor& filters
             );
 
+             // Convolution with the bias, a residual input and relu applied
+             // as the output is written. biases and residual may be null.
+             void operator() (
+                resizable_tensor& output,
+                const tensor& data,
+                const tensor& filters,
+                const tensor* biases,
+                const tensor* residual,
+                const bool relu
+            );
+
+             void winograd (
+                resizable_tensor& output,
+                const tensor& data,
+                const tensor& transformed_filters,
+                const tensor* biases,
+                const tensor* residual,
+                const bool relu
+            );
+
         private:
 
             long last_stride_y = 0;
             long last_stride_x = 0;
             long last_padding_y = 0;
             long last_padding_x = 0;
+
+            bool is_pointwise(const tensor& filters) const
+            {
+                return filters.nr() == 1 && filters.nc() == 1 &&
+                       last_stride_y == 1 && last_stride_x == 1 &&
+                       last_padding_y == 0 && last_padding_x == 0;
+            }
+
+            void convolve (
+                const bool add_to_output,
+                tensor& output,
+                const tensor& data,
+                const tensor& filters,
+                const tensor* biases,
+                const tensor* residual,
+                const bool relu
+            );
+
+            // the unrolled input of the batch and its product with the
+            // filters, sized by the first convolve() that needs them and
+            // kept between calls
+            resizable_tensor img2col_buffer;
+            resizable_tensor conv_products;
+
+            // input tiles and their products with the filters, reused
+            // between calls of winograd()
+            resizable_tensor winograd_data;
+            resizable_tensor winograd_products;
         };
 
+    // -----------------------------------------------------------------------------------
+
+        // Winograd F(2x2,3x3) works on 4x4 input tiles that give 2x2 output tiles.
+        const long WINOGRAD_ALPHA = 4;
+        const long WINOGRAD_TILE = WINOGRAD_ALPHA*WINOGRAD_ALPHA;
+
+        void winograd_transform_filters (
+            resizable_tensor& dest,
+            const tensor& filters
+        );
+
     // -----------------------------------------------------------------------------------
 
         void copy_tensor(
@@ -0,0 +1,157 @@
+// License: Boost Software License   See LICENSE.txt for the full license.
+
+#include "cpu_simd.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+#define DLIB_SIMD_X86
+#ifdef _MSC_VER
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+#endif
+
+namespace dlib
+{
+    namespace cpu
+    {
+    namespace simd
+    {
+
+    // -----------------------------------------------------------------------------------
+
+        namespace
+        {
+            void relu(float* d, const float* s, size_t n)
+            {
+                for (size_t i = 0; i < n; ++i)
+                    d[i] = std::max(s[i], 0.0f);
+            }
+
+            void tanh(float* d, const float* s, size_t n)
+            {
+                for (size_t i = 0; i < n; ++i)
+                    d[i] = std::tanh(s[i]);
+            }
+
+            void softmax(float* d, const float* s, size_t n)
+            {
+                if (n == 0)
+                    return;
+                const float max_val = *std::max_element(s, s + n);
+                float sum = 0;
+                for (size_t i = 0; i < n; ++i)
+                {
+                    d[i] = std::exp(s[i] - max_val);
+                    sum += d[i];
+                }
+                for (size_t i = 0; i < n; ++i)
+                    d[i] /= sum;
+            }
+
+            void scale_shift(float* d, const float* s, float a, float b, size_t n)
+            {
+                for (size_t i = 0; i < n; ++i)
+                    d[i] = a*s[i] + b;
+            }
+
+            void add(float* d, const float* s1, const float* s2, size_t n)
+            {
+                for (size_t i = 0; i < n; ++i)
+                    d[i] = s1[i] + s2[i];
+            }
+
+            void axpby(float* d, float beta, const float* s, float alpha, size_t n)
+            {
+                for (size_t i = 0; i < n; ++i)
+                    d[i] = beta*d[i] + alpha*s[i];
+            }
+
+#ifdef DLIB_SIMD_X86
+#ifdef _MSC_VER
+            struct cpu_features
+            {
+                bool sse4 = false;
+                bool avx2 = false;
+                bool avx512 = false;
+
+                cpu_features()
+                {
+                    int info[4];
+                    __cpuid(info, 0);
+                    const int max_leaf = info[0];
+
+                    __cpuid(info, 1);
+                    sse4 = (info[2] & (1 << 19)) != 0;
+                    const bool fma = (info[2] & (1 << 12)) != 0;
+                    const bool osxsave = (info[2] & (1 << 27)) != 0;
+                    if (!osxsave || max_leaf < 7)
+                        return;
+
+                    // the OS must save the ymm and zmm registers too
+                    const auto xcr0 = _xgetbv(0);
+                    const bool ymm = (xcr0 & 0x6) == 0x6;
+                    const bool zmm = (xcr0 & 0xe6) == 0xe6;
+
+                    __cpuidex(info, 7, 0);
+                    avx2 = ymm && fma && (info[1] & (1 << 5)) != 0;
+                    avx512 = zmm && (info[1] & (1 << 16)) != 0;
+                }
+            };
+#else
+            struct cpu_features
+            {
+                bool sse4 = false;
+                bool avx2 = false;
+                bool avx512 = false;
+
+                cpu_features()
+                {
+                    __builtin_cpu_init();
+                    sse4 = __builtin_cpu_supports("sse4.1");
+                    avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+                    avx512 = __builtin_cpu_supports("avx512f");
+                }
+            };
+#endif
+#endif
+
+            const kernels* pick_kernels()
+            {
+#ifdef DLIB_SIMD_X86
+                const cpu_features cpu;
+                if (cpu.avx512 && avx512_kernels())
+                    return avx512_kernels();
+                if (cpu.avx2 && avx2_kernels())
+                    return avx2_kernels();
+                if (cpu.sse4 && sse4_kernels())
+                    return sse4_kernels();
+#endif
+                return &generic_kernels();
+            }
+        }
+
+    // -----------------------------------------------------------------------------------
+
+        const kernels& generic_kernels()
+        {
+            static const kernels k = {
+                "generic", &relu, &tanh, &softmax, &scale_shift, &add, &axpby
+            };
+            return k;
+        }
+
+        const kernels& get_kernels()
+        {
+            static const kernels* k = pick_kernels();
+            return *k;
+        }
+
+    // -----------------------------------------------------------------------------------
+
+    }
+    }
+}
+
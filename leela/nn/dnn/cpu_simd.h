@@ -0,0 +1,56 @@
+// License: Boost Software License   See LICENSE.txt for the full license.
+#ifndef DLIB_DNN_CPU_SIMD_H_
+#define DLIB_DNN_CPU_SIMD_H_
+
+// Elementwise kernels of the CPU backend, with an implementation for each
+// instruction set picked when the program starts, so one binary runs well
+// on any x86 CPU.
+
+#include <cstddef>
+
+namespace dlib
+{
+    namespace cpu
+    {
+    namespace simd
+    {
+
+    // -----------------------------------------------------------------------------------
+
+        struct kernels
+        {
+            const char* name;
+
+            // d[i] = max(s[i], 0)
+            void (*relu)(float* d, const float* s, size_t n);
+            // d[i] = tanh(s[i])
+            void (*tanh)(float* d, const float* s, size_t n);
+            // d = exp(s - max(s)) / sum(exp(s - max(s)))
+            void (*softmax)(float* d, const float* s, size_t n);
+            // d[i] = a*s[i] + b
+            void (*scale_shift)(float* d, const float* s, float a, float b, size_t n);
+            // d[i] = s1[i] + s2[i]
+            void (*add)(float* d, const float* s1, const float* s2, size_t n);
+            // d[i] = beta*d[i] + alpha*s[i]
+            void (*axpby)(float* d, float beta, const float* s, float alpha, size_t n);
+        };
+
+        // The best kernels this CPU supports.  d may be the same as a source in
+        // all of them.
+        const kernels& get_kernels();
+
+        // The kernels for each instruction set, or nullptr if they weren't
+        // built in.  Only call them if the CPU supports the instruction set.
+        const kernels& generic_kernels();
+        const kernels* sse4_kernels();
+        const kernels* avx2_kernels();
+        const kernels* avx512_kernels();
+
+    // -----------------------------------------------------------------------------------
+
+    }
+    }
+}
+
+#endif // DLIB_DNN_CPU_SIMD_H_
+
@@ -0,0 +1,78 @@
+// License: Boost Software License   See LICENSE.txt for the full license.
+
+// The kernels of cpu_simd.h for AVX2 and FMA, this file is built with
+// -mavx2 -mfma.
+
+#include "cpu_simd.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+
+#include <immintrin.h>
+#include "cpu_simd_impl.h"
+
+namespace
+{
+    struct avx2
+    {
+        using vec = __m256;
+        using mask = __m256;
+        static const size_t width = 8;
+
+        static vec load(const float* p) { return _mm256_loadu_ps(p); }
+        static void store(float* p, vec a) { _mm256_storeu_ps(p, a); }
+        static vec set1(float a) { return _mm256_set1_ps(a); }
+        static vec add(vec a, vec b) { return _mm256_add_ps(a, b); }
+        static vec sub(vec a, vec b) { return _mm256_sub_ps(a, b); }
+        static vec mul(vec a, vec b) { return _mm256_mul_ps(a, b); }
+        static vec div(vec a, vec b) { return _mm256_div_ps(a, b); }
+        static vec max(vec a, vec b) { return _mm256_max_ps(a, b); }
+        static vec min(vec a, vec b) { return _mm256_min_ps(a, b); }
+        static vec fmadd(vec a, vec b, vec c) { return _mm256_fmadd_ps(a, b, c); }
+        static vec round(vec a) { return _mm256_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+        static vec pow2n(vec n)
+        {
+            const __m256i e = _mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127));
+            return _mm256_castsi256_ps(_mm256_slli_epi32(e, 23));
+        }
+        static vec abs(vec a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+        static vec copysign(vec mag, vec sign)
+        {
+            const vec sign_bit = _mm256_set1_ps(-0.0f);
+            return _mm256_or_ps(_mm256_andnot_ps(sign_bit, mag), _mm256_and_ps(sign_bit, sign));
+        }
+        static mask lt(vec a, vec b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+        static vec select(mask m, vec a, vec b) { return _mm256_blendv_ps(b, a, m); }
+        static float hmax(vec a)
+        {
+            __m128 h = _mm_max_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+            h = _mm_max_ps(h, _mm_movehl_ps(h, h));
+            h = _mm_max_ss(h, _mm_shuffle_ps(h, h, 1));
+            return _mm_cvtss_f32(h);
+        }
+        static float hsum(vec a)
+        {
+            __m128 h = _mm_add_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+            h = _mm_add_ps(h, _mm_movehl_ps(h, h));
+            h = _mm_add_ss(h, _mm_shuffle_ps(h, h, 1));
+            return _mm_cvtss_f32(h);
+        }
+    };
+}
+
+namespace dlib { namespace cpu { namespace simd
+{
+    const kernels* avx2_kernels()
+    {
+        static const kernels k = make_kernels<avx2>("avx2");
+        return &k;
+    }
+}}}
+
+#else
+
+namespace dlib { namespace cpu { namespace simd
+{
+    const kernels* avx2_kernels() { return nullptr; }
+}}}
+
+#endif
@@ -0,0 +1,83 @@
+// License: Boost Software License   See LICENSE.txt for the full license.
+
+// The kernels of cpu_simd.h for AVX-512F, this file is built with
+// -mavx512f.
+
+#include "cpu_simd.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+
+// GCC 12 warns about the deliberately undefined values the AVX-512
+// intrinsics start from (GCC bug 105593).
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#endif
+#include <immintrin.h>
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#include "cpu_simd_impl.h"
+
+namespace
+{
+    struct avx512
+    {
+        using vec = __m512;
+        using mask = __mmask16;
+        static const size_t width = 16;
+
+        static vec load(const float* p) { return _mm512_loadu_ps(p); }
+        static void store(float* p, vec a) { _mm512_storeu_ps(p, a); }
+        static vec set1(float a) { return _mm512_set1_ps(a); }
+        static vec add(vec a, vec b) { return _mm512_add_ps(a, b); }
+        static vec sub(vec a, vec b) { return _mm512_sub_ps(a, b); }
+        static vec mul(vec a, vec b) { return _mm512_mul_ps(a, b); }
+        static vec div(vec a, vec b) { return _mm512_div_ps(a, b); }
+        static vec max(vec a, vec b) { return _mm512_max_ps(a, b); }
+        static vec min(vec a, vec b) { return _mm512_min_ps(a, b); }
+        static vec fmadd(vec a, vec b, vec c) { return _mm512_fmadd_ps(a, b, c); }
+        static vec round(vec a) { return _mm512_roundscale_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+        static vec pow2n(vec n)
+        {
+            const __m512i e = _mm512_add_epi32(_mm512_cvtps_epi32(n), _mm512_set1_epi32(127));
+            return _mm512_castsi512_ps(_mm512_slli_epi32(e, 23));
+        }
+        // AVX-512F has no float bitwise operations, they need AVX-512DQ
+        static vec abs(vec a)
+        {
+            return _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(a),
+                                                        _mm512_set1_epi32(0x7fffffff)));
+        }
+        static vec copysign(vec mag, vec sign)
+        {
+            const __m512i sign_bit = _mm512_set1_epi32(static_cast<int>(0x80000000u));
+            return _mm512_castsi512_ps(_mm512_or_si512(
+                _mm512_andnot_si512(sign_bit, _mm512_castps_si512(mag)),
+                _mm512_and_si512(sign_bit, _mm512_castps_si512(sign))));
+        }
+        static mask lt(vec a, vec b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+        static vec select(mask m, vec a, vec b) { return _mm512_mask_blend_ps(m, b, a); }
+        static float hmax(vec a) { return _mm512_reduce_max_ps(a); }
+        static float hsum(vec a) { return _mm512_reduce_add_ps(a); }
+    };
+}
+
+namespace dlib { namespace cpu { namespace simd
+{
+    const kernels* avx512_kernels()
+    {
+        static const kernels k = make_kernels<avx512>("avx512f");
+        return &k;
+    }
+}}}
+
+#else
+
+namespace dlib { namespace cpu { namespace simd
+{
+    const kernels* avx512_kernels() { return nullptr; }
+}}}
+
+#endif
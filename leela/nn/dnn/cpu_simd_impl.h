@@ -0,0 +1,212 @@
+// License: Boost Software License   See LICENSE.txt for the full license.
+#ifndef DLIB_DNN_CPU_SIMD_IMPL_H_
+#define DLIB_DNN_CPU_SIMD_IMPL_H_
+
+// The kernels of cpu_simd.h written once against a vector type V, which the
+// cpp file for each instruction set defines around its intrinsics:
+//
+//   vec, width, load, store, set1, add, sub, mul, div, max, min,
+//   fmadd(a,b,c) == a*b+c, round, pow2n(n) == 2^n for integral n,
+//   abs, copysign, lt, select(mask,a,b) == mask ? a : b, hmax, hsum
+//
+// This is included by those files only and must stay free of inline
+// functions from other headers: they would be compiled for the wider
+// instruction set and the linker could pick them for the rest of the
+// program.  V is declared in an anonymous namespace, which keeps all of
+// the instantiations below local to their file.
+
+#include "cpu_simd.h"
+
+namespace dlib
+{
+    namespace cpu
+    {
+    namespace simd
+    {
+
+    // -----------------------------------------------------------------------------------
+
+        template <class V>
+        struct vector_kernels
+        {
+            using vec = typename V::vec;
+            static const size_t W = V::width;
+
+            // Cephes expf, the input clamped so the result stays a normal float.
+            static vec exp(vec x)
+            {
+                x = V::min(V::max(x, V::set1(-87.3f)), V::set1(88.0f));
+                const vec n = V::round(V::mul(x, V::set1(1.44269504088896341f)));
+                x = V::fmadd(n, V::set1(-0.693359375f), x);
+                x = V::fmadd(n, V::set1(2.12194440e-4f), x);
+
+                vec y = V::set1(1.9875691500e-4f);
+                y = V::fmadd(y, x, V::set1(1.3981999507e-3f));
+                y = V::fmadd(y, x, V::set1(8.3334519073e-3f));
+                y = V::fmadd(y, x, V::set1(4.1665795894e-2f));
+                y = V::fmadd(y, x, V::set1(1.6666665459e-1f));
+                y = V::fmadd(y, x, V::set1(5.0000001201e-1f));
+                y = V::fmadd(y, V::mul(x, x), V::add(x, V::set1(1.0f)));
+                return V::mul(y, V::pow2n(n));
+            }
+
+            // Cephes tanhf: a polynomial near 0, 1 - 2/(exp(2x) + 1) elsewhere.
+            static vec tanh(vec x)
+            {
+                const vec ax = V::abs(x);
+
+                const vec z = V::mul(x, x);
+                vec p = V::set1(-5.70498872745e-3f);
+                p = V::fmadd(p, z, V::set1(2.06390887954e-2f));
+                p = V::fmadd(p, z, V::set1(-5.37397155531e-2f));
+                p = V::fmadd(p, z, V::set1(1.33314422036e-1f));
+                p = V::fmadd(p, z, V::set1(-3.33332819422e-1f));
+                const vec small = V::fmadd(V::mul(x, z), p, x);
+
+                const vec e = exp(V::mul(ax, V::set1(-2.0f)));
+                const vec one = V::set1(1.0f);
+                const vec large = V::copysign(V::div(V::sub(one, e), V::add(one, e)), x);
+
+                return V::select(V::lt(ax, V::set1(0.625f)), small, large);
+            }
+
+            // d = f(s) over n floats, the last partial vector through a buffer.
+            template <class F>
+            static void map(float* d, const float* s, size_t n, F f)
+            {
+                size_t i = 0;
+                for (; i + W <= n; i += W)
+                    V::store(d + i, f(V::load(s + i)));
+                if (i < n)
+                {
+                    float buf[W] = {};
+                    for (size_t j = 0; j < n - i; ++j)
+                        buf[j] = s[i + j];
+                    V::store(buf, f(V::load(buf)));
+                    for (size_t j = 0; j < n - i; ++j)
+                        d[i + j] = buf[j];
+                }
+            }
+
+            // d = f(s1, s2) over n floats.
+            template <class F>
+            static void map2(float* d, const float* s1, const float* s2, size_t n, F f)
+            {
+                size_t i = 0;
+                for (; i + W <= n; i += W)
+                    V::store(d + i, f(V::load(s1 + i), V::load(s2 + i)));
+                if (i < n)
+                {
+                    float buf1[W] = {};
+                    float buf2[W] = {};
+                    for (size_t j = 0; j < n - i; ++j)
+                    {
+                        buf1[j] = s1[i + j];
+                        buf2[j] = s2[i + j];
+                    }
+                    V::store(buf1, f(V::load(buf1), V::load(buf2)));
+                    for (size_t j = 0; j < n - i; ++j)
+                        d[i + j] = buf1[j];
+                }
+            }
+
+            static void relu(float* d, const float* s, size_t n)
+            {
+                const vec zero = V::set1(0.0f);
+                map(d, s, n, [&](vec x) { return V::max(x, zero); });
+            }
+
+            static void tanh(float* d, const float* s, size_t n)
+            {
+                map(d, s, n, [](vec x) { return tanh(x); });
+            }
+
+            static void softmax(float* d, const float* s, size_t n)
+            {
+                if (n == 0)
+                    return;
+
+                size_t i = 0;
+                vec vmax = V::set1(s[0]);
+                for (; i + W <= n; i += W)
+                    vmax = V::max(vmax, V::load(s + i));
+                float max_val = V::hmax(vmax);
+                for (; i < n; ++i)
+                    max_val = s[i] > max_val ? s[i] : max_val;
+
+                const vec m = V::set1(max_val);
+                vec vsum = V::set1(0.0f);
+                for (i = 0; i + W <= n; i += W)
+                {
+                    const vec e = exp(V::sub(V::load(s + i), m));
+                    V::store(d + i, e);
+                    vsum = V::add(vsum, e);
+                }
+                float sum = V::hsum(vsum);
+                if (i < n)
+                {
+                    float buf[W] = {};
+                    for (size_t j = 0; j < n - i; ++j)
+                        buf[j] = s[i + j];
+                    V::store(buf, exp(V::sub(V::load(buf), m)));
+                    for (size_t j = 0; j < n - i; ++j)
+                    {
+                        d[i + j] = buf[j];
+                        sum += buf[j];
+                    }
+                }
+
+                const vec scale = V::set1(1.0f/sum);
+                map(d, d, n, [&](vec x) { return V::mul(x, scale); });
+            }
+
+            static void scale_shift(float* d, const float* s, float a, float b, size_t n)
+            {
+                const vec va = V::set1(a);
+                const vec vb = V::set1(b);
+                map(d, s, n, [&](vec x) { return V::fmadd(va, x, vb); });
+            }
+
+            static void add(float* d, const float* s1, const float* s2, size_t n)
+            {
+                map2(d, s1, s2, n, [](vec x, vec y) { return V::add(x, y); });
+            }
+
+            static void axpby(float* d, float beta, const float* s, float alpha, size_t n)
+            {
+                const vec va = V::set1(alpha);
+                if (beta == 1)
+                {
+                    map2(d, d, s, n, [&](vec x, vec y) { return V::fmadd(va, y, x); });
+                }
+                else
+                {
+                    const vec vb = V::set1(beta);
+                    map2(d, d, s, n, [&](vec x, vec y) { return V::fmadd(vb, x, V::mul(va, y)); });
+                }
+            }
+        };
+
+        template <class V>
+        kernels make_kernels(const char* name)
+        {
+            using K = vector_kernels<V>;
+            kernels k;
+            k.name = name;
+            k.relu = &K::relu;
+            k.tanh = &K::tanh;
+            k.softmax = &K::softmax;
+            k.scale_shift = &K::scale_shift;
+            k.add = &K::add;
+            k.axpby = &K::axpby;
+            return k;
+        }
+
+    // -----------------------------------------------------------------------------------
+
+    }
+    }
+}
+
+#endif // DLIB_DNN_CPU_SIMD_IMPL_H_
+
@@ -0,0 +1,75 @@
+// License: Boost Software License   See LICENSE.txt for the full license.
+
+// The kernels of cpu_simd.h for SSE4.1, this file is built with -msse4.1.
+
+#include "cpu_simd.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+
+#include <immintrin.h>
+#include "cpu_simd_impl.h"
+
+namespace
+{
+    struct sse4
+    {
+        using vec = __m128;
+        using mask = __m128;
+        static const size_t width = 4;
+
+        static vec load(const float* p) { return _mm_loadu_ps(p); }
+        static void store(float* p, vec a) { _mm_storeu_ps(p, a); }
+        static vec set1(float a) { return _mm_set1_ps(a); }
+        static vec add(vec a, vec b) { return _mm_add_ps(a, b); }
+        static vec sub(vec a, vec b) { return _mm_sub_ps(a, b); }
+        static vec mul(vec a, vec b) { return _mm_mul_ps(a, b); }
+        static vec div(vec a, vec b) { return _mm_div_ps(a, b); }
+        static vec max(vec a, vec b) { return _mm_max_ps(a, b); }
+        static vec min(vec a, vec b) { return _mm_min_ps(a, b); }
+        static vec fmadd(vec a, vec b, vec c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+        static vec round(vec a) { return _mm_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+        static vec pow2n(vec n)
+        {
+            const __m128i e = _mm_add_epi32(_mm_cvtps_epi32(n), _mm_set1_epi32(127));
+            return _mm_castsi128_ps(_mm_slli_epi32(e, 23));
+        }
+        static vec abs(vec a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+        static vec copysign(vec mag, vec sign)
+        {
+            const vec sign_bit = _mm_set1_ps(-0.0f);
+            return _mm_or_ps(_mm_andnot_ps(sign_bit, mag), _mm_and_ps(sign_bit, sign));
+        }
+        static mask lt(vec a, vec b) { return _mm_cmplt_ps(a, b); }
+        static vec select(mask m, vec a, vec b) { return _mm_blendv_ps(b, a, m); }
+        static float hmax(vec a)
+        {
+            a = _mm_max_ps(a, _mm_movehl_ps(a, a));
+            a = _mm_max_ss(a, _mm_shuffle_ps(a, a, 1));
+            return _mm_cvtss_f32(a);
+        }
+        static float hsum(vec a)
+        {
+            a = _mm_add_ps(a, _mm_movehl_ps(a, a));
+            a = _mm_add_ss(a, _mm_shuffle_ps(a, a, 1));
+            return _mm_cvtss_f32(a);
+        }
+    };
+}
+
+namespace dlib { namespace cpu { namespace simd
+{
+    const kernels* sse4_kernels()
+    {
+        static const kernels k = make_kernels<sse4>("sse4.1");
+        return &k;
+    }
+}}}
+
+#else
+
+namespace dlib { namespace cpu { namespace simd
+{
+    const kernels* sse4_kernels() { return nullptr; }
+}}}
+
+#endif
@@ -76,7 +76,7 @@ namespace dlib
                 host_current = true;
                 device_current = true;
                 device_in_use = false;
-                data_host.reset(new float[new_size], std::default_delete<float[]>());
+                data_host = alloc_host(new_size);
                 data_device.reset();
             }
         }
@@ -168,6 +168,22 @@ namespace dlib
 #endif
 
 
+#ifndef DLIB_USE_CUDA
+        // Host memory aligned to a cache line, which is also enough for
+        // any vector loads the CPU code does.
+        static std::shared_ptr<float> alloc_host(size_t size)
+        {
+            const size_t alignment = 64;
+            const size_t pad = alignment/sizeof(float);
+            float* raw = new float[size + pad];
+            void* aligned = raw;
+            size_t space = (size + pad)*sizeof(float);
+            std::align(alignment, size*sizeof(float), aligned, space);
+            return std::shared_ptr<float>(static_cast<float*>(aligned),
+                                          [raw](float*) { delete[] raw; });
+        }
+#endif
+
         size_t data_size;
         mutable bool host_current;
         mutable bool device_current;
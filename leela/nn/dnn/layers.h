@@ -5,6 +5,8 @@
 
 #include "tensor.h"
 #include "core.h"
+#include <array>
+#include <cmath>
 #include <iostream>
 #include <string>
 #include "tensor_tools.h"
@@ -68,12 +70,14 @@ namespace dlib
         ) : 
             weights(item.weights),
             biases(item.biases),
+            winograd_weights(item.winograd_weights),
             num_filters_(item.num_filters_),
             padding_y_(item.padding_y_),
             padding_x_(item.padding_x_)
         {
             // this->conv is non-copyable and basically stateless, so we have to write our
-            // own copy to avoid trying to copy it and getting an error.
+            // own copy to avoid trying to copy it and getting an error.  The parameters
+            // are never modified after consume_params(), so copies share them.
         }
 
         con_& operator= (
@@ -87,6 +91,7 @@ namespace dlib
             // own copy to avoid trying to copy it and getting an error.
             weights = item.weights;
             biases = item.biases;
+            winograd_weights = item.winograd_weights;
             padding_y_ = item.padding_y_;
             padding_x_ = item.padding_x_;
             num_filters_ = item.num_filters_;
@@ -107,8 +112,18 @@ namespace dlib
                 shape[3] != _nc)
                 throw std::runtime_error("Wrong weights shape found while deserializing dlib::con_");
 
-            weights.set_size(_num_filters, shape[1], _nr, _nc);
-            std::copy(data.begin(), data.end(), weights.host_write_only());
+            auto w = std::make_shared<resizable_tensor>(_num_filters, shape[1], _nr, _nc);
+            std::copy(data.begin(), data.end(), w->host_write_only());
+            weights = std::move(w);
+
+#ifndef DLIB_USE_CUDA
+            if (tt::tensor_conv::can_use_winograd(_nr, _nc, _stride_y, _stride_x,
+                                                  padding_y_, padding_x_)) {
+                auto u = std::make_shared<resizable_tensor>();
+                tt::tensor_conv::transform_filters_for_winograd(*u, *weights);
+                winograd_weights = std::move(u);
+            }
+#endif
 
 
             if (bias_mode == FC_HAS_BIAS) {
@@ -119,8 +134,9 @@ namespace dlib
                 if (data.size() != _num_filters)
                     throw std::runtime_error("Wrong weights shape found while deserializing dlib::con_bias");
 
-                biases.set_size(1, _num_filters);
-                std::copy(data.begin(), data.end(), biases.host_write_only());
+                auto b = std::make_shared<resizable_tensor>(1, _num_filters);
+                std::copy(data.begin(), data.end(), b->host_write_only());
+                biases = std::move(b);
             }
 
             return it;
@@ -130,17 +146,18 @@ namespace dlib
         void forward(const SUBNET& sub, resizable_tensor& output)
         {
             conv.setup(sub.get_output(),
-                        weights,
+                        *weights,
                        _stride_y,
                        _stride_x,
                        padding_y_,
                        padding_x_);
-            conv(false, output,
-                sub.get_output(), weights);
-
-            if (bias_mode == FC_HAS_BIAS) {
-                tt::add(1,output,1,biases);
-            }
+            const tensor* b = bias_mode == FC_HAS_BIAS ? biases.get() : nullptr;
+#ifndef DLIB_USE_CUDA
+            if (winograd_weights) {
+                conv.winograd(output, sub.get_output(), *winograd_weights, b, nullptr, false);
+            } else
+#endif
+            conv(output, sub.get_output(), *weights, b, nullptr, false);
         } 
 
 
@@ -160,7 +177,11 @@ namespace dlib
 
     private:
 
-        resizable_tensor weights, biases;
+        // shared between copies of this layer, see the copy constructor
+        std::shared_ptr<const resizable_tensor> weights, biases;
+        // weights already transformed for tensor_conv::winograd(), set
+        // only for the filters it can handle
+        std::shared_ptr<const resizable_tensor> winograd_weights;
 
         tt::tensor_conv conv;
         long num_filters_;
@@ -194,6 +215,172 @@ namespace dlib
 
 
 
+// ----------------------------------------------------------------------------------------
+
+    // Marks a con_bn_ layer that adds no residual input.
+    template <typename SUBNET> class no_residual;
+
+    namespace impl
+    {
+        template <template<typename> class tag>
+        struct residual_input
+        {
+            template <typename SUBNET>
+            static const tensor* get(const SUBNET& sub) { return &layer<tag>(sub).get_output(); }
+        };
+
+        template <>
+        struct residual_input<no_residual>
+        {
+            template <typename SUBNET>
+            static const tensor* get(const SUBNET&) { return nullptr; }
+        };
+    }
+
+    /*
+        A stride 1 convolution followed by a batch normalization, optionally the
+        output of the layer tagged residual_tag added in, and optionally a relu:
+        the inference form of affine<con<...>>, add_prev and relu in one layer.
+        The batch normalization is folded into the filters and a bias when the
+        parameters are loaded, and the rest is applied as the convolution writes
+        its output, so the activations are only written once.
+    */
+    template <
+        long _num_filters,
+        long _nr,
+        long _nc,
+        bool _relu,
+        template<typename> class _residual_tag = no_residual
+        >
+    class con_bn_
+    {
+    public:
+
+        static_assert(_num_filters > 0, "The number of filters must be > 0");
+        static_assert(_nr > 0 && _nc > 0, "The filter size must be > 0");
+
+        con_bn_() {}
+
+        con_bn_ (
+            const con_bn_& item
+        ) : 
+            weights(item.weights),
+            biases(item.biases),
+            winograd_weights(item.winograd_weights)
+        {
+            // this->conv is non-copyable, see con_.
+        }
+
+        con_bn_& operator= (
+            const con_bn_& item
+        )
+        {
+            weights = item.weights;
+            biases = item.biases;
+            winograd_weights = item.winograd_weights;
+            return *this;
+        }
+
+        std::vector<param_data>::const_iterator 
+        consume_params(std::vector<param_data>::const_iterator it) {
+
+            // the filters, then gamma, beta, running mean and variance
+            // of the batch normalization, as con_ and affine_ read them
+            auto& shape = it->shape;
+            auto& data = it->data;
+            it++;
+
+            if (shape.size() != 4 || 
+                shape[0] != _num_filters ||
+                shape[2] != _nr ||
+                shape[3] != _nc)
+                throw std::runtime_error("Wrong weights shape found while deserializing dlib::con_bn_");
+
+            std::array<std::vector<float>, 4> bn;
+            for (auto& p : bn) {
+                if (it->shape.size() != 4 || 
+                    it->shape[0] != 1 ||
+                    it->shape[1] != _num_filters ||
+                    it->shape[2] != 1 ||
+                    it->shape[3] != 1)
+                    throw std::runtime_error("Wrong batch normalization shape found while deserializing dlib::con_bn_");
+                p = it->data;
+                it++;
+            }
+            auto& gamma = bn[0];
+            auto& beta = bn[1];
+            auto& running_means = bn[2];
+            auto& running_variances = bn[3];
+            const double eps=1e-05;
+
+            auto w = std::make_shared<resizable_tensor>(_num_filters, shape[1], _nr, _nc);
+            auto b = std::make_shared<resizable_tensor>(1, _num_filters);
+            const long filter_size = shape[1]*_nr*_nc;
+            auto wdst = w->host_write_only();
+            auto bdst = b->host_write_only();
+            for (long k = 0; k < _num_filters; ++k) {
+                const float scale = gamma[k]/std::sqrt(running_variances[k]+eps);
+                for (long i = 0; i < filter_size; ++i)
+                    wdst[k*filter_size + i] = data[k*filter_size + i]*scale;
+                bdst[k] = beta[k] - scale*running_means[k];
+            }
+            weights = std::move(w);
+            biases = std::move(b);
+
+#ifndef DLIB_USE_CUDA
+            if (tt::tensor_conv::can_use_winograd(_nr, _nc, 1, 1, _nr/2, _nc/2)) {
+                auto u = std::make_shared<resizable_tensor>();
+                tt::tensor_conv::transform_filters_for_winograd(*u, *weights);
+                winograd_weights = std::move(u);
+            }
+#endif
+
+            return it;
+        }
+
+        template <typename SUBNET>
+        void forward(const SUBNET& sub, resizable_tensor& output)
+        {
+            const tensor* residual = impl::residual_input<_residual_tag>::get(sub);
+            conv.setup(sub.get_output(), *weights, 1, 1, _nr/2, _nc/2);
+#ifndef DLIB_USE_CUDA
+            if (winograd_weights) {
+                conv.winograd(output, sub.get_output(), *winograd_weights,
+                              biases.get(), residual, _relu);
+            } else
+#endif
+            conv(output, sub.get_output(), *weights, biases.get(), residual, _relu);
+        } 
+
+        friend std::ostream& operator<<(std::ostream& out, const con_bn_& )
+        {
+            out << "con_bn\t ("
+                << "num_filters="<<_num_filters
+                << ", nr="<<_nr
+                << ", nc="<<_nc
+                << ", relu="<<_relu
+                << ")";
+            return out;
+        }
+
+    private:
+
+        // shared between copies of this layer, see the copy constructor
+        std::shared_ptr<const resizable_tensor> weights, biases;
+        std::shared_ptr<const resizable_tensor> winograd_weights;
+
+        tt::tensor_conv conv;
+    };
+
+    template <long num_filters, long nr, long nc, typename SUBNET>
+    using con_bn = add_layer<con_bn_<num_filters,nr,nc,false>, SUBNET>;
+
+    template <long num_filters, long nr, long nc, typename SUBNET>
+    using con_bn_relu = add_layer<con_bn_<num_filters,nr,nc,true>, SUBNET>;
+
+    template <long num_filters, long nr, long nc, template<typename> class tag, typename SUBNET>
+    using con_bn_add_relu = add_layer<con_bn_<num_filters,nr,nc,true,tag>, SUBNET>;
+
 // ----------------------------------------------------------------------------------------
 // ----------------------------------------------------------------------------------------
 
@@ -238,8 +425,9 @@ namespace dlib
                 throw std::runtime_error("Wrong weights shape found while deserializing dlib::fc_");
 
             num_inputs = shape[0];
-            weights.set_size(shape[0], num_outputs_);
-            std::copy(data.begin(), data.end(), weights.host_write_only());
+            auto w = std::make_shared<resizable_tensor>(shape[0], num_outputs_);
+            std::copy(data.begin(), data.end(), w->host_write_only());
+            weights = std::move(w);
 
             
 
@@ -251,8 +439,9 @@ namespace dlib
                 if (data.size() != num_outputs_)
                     throw std::runtime_error("Wrong weights shape found while deserializing dlib::fc_");
 
-                biases.set_size(1, num_outputs_);
-                std::copy(data.begin(), data.end(), biases.host_write_only());
+                auto b = std::make_shared<resizable_tensor>(1, num_outputs_);
+                std::copy(data.begin(), data.end(), b->host_write_only());
+                biases = std::move(b);
             }
 
             return it;
@@ -265,10 +454,10 @@ namespace dlib
                 "The size of the input tensor to this fc layer doesn't match the size the fc layer was trained with.");
             output.set_size(sub.get_output().num_samples(), num_outputs);
 
-            tt::gemm(0,output, 1,sub.get_output(),false, weights,false);
+            tt::gemm(0,output, 1,sub.get_output(),false, *weights,false);
             if (bias_mode == FC_HAS_BIAS)
             {
-                tt::add(1,output,1,biases);
+                tt::add(1,output,1,*biases);
             }
         } 
 
@@ -293,7 +482,8 @@ namespace dlib
 
         unsigned long num_outputs;
         unsigned long num_inputs;
-        resizable_tensor weights, biases;
+        // immutable once loaded, shared between copies of this layer
+        std::shared_ptr<const resizable_tensor> weights, biases;
     };
 
     template <
@@ -316,7 +506,7 @@ namespace dlib
         std::vector<param_data>::const_iterator 
         consume_params(std::vector<param_data>::const_iterator it) {
             
-            resizable_tensor running_means, running_variances;
+            resizable_tensor gamma, beta, running_means, running_variances;
             const double eps=1e-05;
 
             for (int i=0; i<4; i++, it++) {
@@ -348,12 +538,15 @@ namespace dlib
             gamma = pointwise_multiply(mat(gamma), 1.0f/sqrt(mat(running_variances)+eps));
             beta = mat(beta) - pointwise_multiply(mat(gamma), mat(running_means));
 
+            this->gamma = std::make_shared<resizable_tensor>(std::move(gamma));
+            this->beta = std::make_shared<resizable_tensor>(std::move(beta));
+
             return it;
         }
 
         void forward_inplace(const tensor& input, tensor& output)
         {
-            tt::affine_transform_conv(output, input, gamma, beta);
+            tt::affine_transform_conv(output, input, *gamma, *beta);
         } 
 
         friend std::ostream& operator<<(std::ostream& out, const affine_& )
@@ -363,7 +556,8 @@ namespace dlib
         }
 
     private:
-        resizable_tensor gamma, beta;
+        // immutable once loaded, shared between copies of this layer
+        std::shared_ptr<const resizable_tensor> gamma, beta;
     };
 
     template <typename SUBNET>
@@ -402,6 +402,30 @@ namespace dlib { namespace tt
 #endif
     }
 
+// ----------------------------------------------------------------------------------------
+
+    void tensor_conv::operator() (
+        resizable_tensor& output,
+        const tensor& data,
+        const tensor& filters,
+        const tensor* biases,
+        const tensor* residual,
+        const bool relu
+    )
+    {
+#ifdef DLIB_USE_CUDA
+        impl(false, output, data, filters);
+        if (biases)
+            tt::add(1, output, 1, *biases);
+        if (residual)
+            tt::add(output, output, *residual);
+        if (relu)
+            tt::relu(output, output);
+#else
+        impl(output, data, filters, biases, residual, relu);
+#endif
+    }
+
 // ------------------------------------------------------------------------------------
 
     void copy_tensor(
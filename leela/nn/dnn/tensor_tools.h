@@ -359,6 +359,25 @@ namespace dlib { namespace tt
             const tensor& filters
         ) { impl(add_to_output,output,data,filters); }
 
+        void operator() (
+            resizable_tensor& output,
+            const tensor& data,
+            const tensor& filters,
+            const tensor* biases,
+            const tensor* residual,
+            const bool relu
+        );
+        /*!
+            requires
+                - The same as the operator() above.
+                - biases == nullptr or biases->size() == filters.num_samples()
+                - residual == nullptr or residual has the dimensions of #output
+            ensures
+                - Convolves filters over data into output, then adds biases (one per
+                  output channel) and residual if they are given and clamps negative
+                  values to 0 if relu == true.  On the CPU this happens while the
+                  output is written, not as separate passes over it.
+        !*/
  
         void setup(
             const tensor& data,
@@ -388,7 +407,61 @@ namespace dlib { namespace tt
                   the tensors, or store any kind of references to the data or filter
                   tensors. 
         !*/
-       
+
+        static bool can_use_winograd(
+            long filter_nr,
+            long filter_nc,
+            int stride_y,
+            int stride_x,
+            int padding_y,
+            int padding_x
+        )
+        {
+#ifdef DLIB_USE_CUDA
+            return false;
+#else
+            return filter_nr == 3 && filter_nc == 3 &&
+                   stride_y == 1 && stride_x == 1 &&
+                   padding_y == 1 && padding_x == 1;
+#endif
+        }
+        /*!
+            ensures
+                - returns true if winograd() can be used in place of operator() for
+                  filters of this size with these settings.
+        !*/
+
+#ifndef DLIB_USE_CUDA
+        static void transform_filters_for_winograd(
+            resizable_tensor& dest,
+            const tensor& filters
+        ) { cpu::winograd_transform_filters(dest, filters); }
+        /*!
+            requires
+                - filters.nr() == 3 && filters.nc() == 3
+            ensures
+                - #dest holds filters in the form winograd() expects.
+        !*/
+
+        void winograd(
+            resizable_tensor& output,
+            const tensor& data,
+            const tensor& transformed_filters,
+            const tensor* biases,
+            const tensor* residual,
+            const bool relu
+        ) { impl.winograd(output, data, transformed_filters, biases, residual, relu); }
+        /*!
+            requires
+                - setup() has been called with settings for which can_use_winograd()
+                  is true.
+                - transformed_filters was made by transform_filters_for_winograd()
+            ensures
+                - Same as the fused operator(), but uses the Winograd F(2x2,3x3)
+                  algorithm, which needs 2.25 times fewer multiplications.
+        !*/
+#endif
+
     private:
 #ifdef DLIB_USE_CUDA
         cuda::tensor_conv impl;
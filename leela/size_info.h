@@ -1,10 +1,54 @@
 #pragma once
 
+#include <cassert>
+#include <utility>
+
+// The board size everything is built for, pick it with
+// cmake -DBOARD_SIZE=9 (or 13, 19).
+#ifndef BOARD_SIZE
+#define BOARD_SIZE 19
+#endif
+
 namespace zero {
 
-constexpr int board_size = 19;
-constexpr int board_count = board_size*board_size;
-constexpr int board_moves = board_count + 1;
+// Sizes of the board, the network planes and the policy
+// output for a SIZE x SIZE board.
+template<int SIZE>
+struct size_info {
+    static_assert(SIZE == 9 || SIZE == 13 || SIZE == 19,
+                  "Supported board sizes are 9, 13 and 19.");
+
+    static constexpr int board_size = SIZE;
+    static constexpr int board_count = board_size*board_size;
+    static constexpr int board_moves = board_count + 1;
+
+    // Map a vertex to one of the 8 symmetries of the board.
+    static int rotate_vertex(int vertex, int symmetry) {
+        assert(vertex >= 0 && vertex < board_count);
+        assert(symmetry >= 0 && symmetry < 8);
+        int x = vertex % board_size;
+        int y = vertex / board_size;
+
+        if (symmetry >= 4) {
+            std::swap(x, y);
+            symmetry -= 4;
+        }
+        if (symmetry == 1 || symmetry == 3) {
+            y = board_size - y - 1;
+        }
+        if (symmetry == 2 || symmetry == 3) {
+            x = board_size - x - 1;
+        }
+
+        return y * board_size + x;
+    }
+};
+
+using board_info = size_info<BOARD_SIZE>;
+
+constexpr int board_size = board_info::board_size;
+constexpr int board_count = board_info::board_count;
+constexpr int board_moves = board_info::board_moves;
 
 static constexpr int input_history = 8;
 static constexpr int input_channels = 2 * input_history + 2;
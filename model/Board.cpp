@@ -4,60 +4,33 @@
 
 
 
-static std::array<std::vector<int>, 361> NEIGHBORS;
+using zero::board_size;
+using zero::board_count;
+
+static std::array<std::vector<int>, board_count> NEIGHBORS;
 
 // Rotation helper
-std::array<std::array<int, 361>, 8> rotate_nn_idx_table;
+std::array<std::array<int, board_count>, 8> rotate_nn_idx_table;
 
 int rotate_nn_idx(const int vertex, int symmetry) {
-
-    assert(vertex >= 0 && vertex < 361);
-    assert(symmetry >= 0 && symmetry < 8);
-    int x = vertex % 19;
-    int y = vertex / 19;
-    int newx;
-    int newy;
-
-    if (symmetry >= 4) {
-        std::swap(x, y);
-        symmetry -= 4;
-    }
-
-    if (symmetry == 0) {
-        newx = x;
-        newy = y;
-    } else if (symmetry == 1) {
-        newx = x;
-        newy = 19 - y - 1;
-    } else if (symmetry == 2) {
-        newx = 19 - x - 1;
-        newy = y;
-    } else {
-        assert(symmetry == 3);
-        newx = 19 - x - 1;
-        newy = 19 - y - 1;
-    }
-
-    int newvtx = (newy * 19) + newx;
-
-    return newvtx;
+    return zero::board_info::rotate_vertex(vertex, symmetry);
 }
 
 void GoBoard::init_board() {
-    for (int y=0; y<19; y++) {
-        for (int x=0; x<19; x++) {
-            auto& n = NEIGHBORS[y*19 + x];
-
-            if (y > 0) n.emplace_back((y-1)*19 + x);
-            if (y < 19-1) n.emplace_back((y+1)*19 + x);
-            if (x > 0) n.emplace_back(y*19 + x - 1);
-            if (x < 19-1) n.emplace_back(y*19 + x + 1);
+    for (int y=0; y<board_size; y++) {
+        for (int x=0; x<board_size; x++) {
+            auto& n = NEIGHBORS[y*board_size + x];
+
+            if (y > 0) n.emplace_back((y-1)*board_size + x);
+            if (y < board_size-1) n.emplace_back((y+1)*board_size + x);
+            if (x > 0) n.emplace_back(y*board_size + x - 1);
+            if (x < board_size-1) n.emplace_back(y*board_size + x + 1);
         }
     }
 
     // Prepare rotation table
     for(auto s = 0; s < 8; s++) {
-        for(auto v = 0; v < 19 * 19; v++) {
+        for(auto v = 0; v < board_count; v++) {
             rotate_nn_idx_table[s][v] = rotate_nn_idx(v, s);
         }
     }
@@ -81,14 +54,14 @@ public:
 
 void GoBoard::reset() {
     
-    for (int i = 0; i < 361; i++) {
+    for (int i = 0; i < board_count; i++) {
         stones[i] = 0;
     }
 }
 
 void GoBoard::update_board(const int color, const int i, std::vector<int>& removed) {
 
-    if (i <0 || i >= 361 || stones[i]) {
+    if (i <0 || i >= board_count || stones[i]) {
         std::cout << i << std::endl;
         std::cout << stones[i] << std::endl;
         throw std::runtime_error("update board error");
@@ -211,14 +184,14 @@ bool GoBoard::generate_move_seqs(const std::vector<int>& moves, std::vector<shor
 
     for (auto idx : moves) {
 
-        if (idx < 0 || idx > 361) {
+        if (idx < 0 || idx > board_count) {
             return false; // invalid move
         }
 
         std::vector<int> removed;
         short sign_idx = (short)(idx + 1);
         
-        if (idx == 361) {
+        if (idx == board_count) {
             // pass or resign
         } else {
             if (b.stones[idx] != 0) {
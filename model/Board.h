@@ -6,7 +6,7 @@
 #include <bitset>
 #include "../leela/size_info.h"
 
-extern std::array<std::array<int, 361>, 8> rotate_nn_idx_table;
+extern std::array<std::array<int, zero::board_count>, 8> rotate_nn_idx_table;
 
 class GoBoard {
 public:
@@ -25,8 +25,8 @@ private:
     void merge_strings(const int ip, const int aip);
     void remove_string(int i, std::vector<int>& removed);
 
-    int stones[361];
-    int group_ids[361];
-    int group_libs[361];
-    int stone_next[361];
+    int stones[zero::board_count];
+    int group_ids[zero::board_count];
+    int group_libs[zero::board_count];
+    int stone_next[zero::board_count];
 };
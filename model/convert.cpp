@@ -23,8 +23,8 @@ void proceed_moves(std::ostream& os, int result, std::vector<int> tree_moves,
     int64_t& total_size) {
 
     if (tree_moves.size() >=2 && 
-        tree_moves[tree_moves.size()-2] == 361 && 
-        tree_moves[tree_moves.size()-1] == 361)
+        tree_moves[tree_moves.size()-2] == zero::board_count && 
+        tree_moves[tree_moves.size()-1] == zero::board_count)
         tree_moves.erase(tree_moves.end()-1);
 
     std::vector<short> seqs;
@@ -85,7 +85,7 @@ void parse_sgf_file(std::ostream& os, const std::string& sgf_name,
         std::istringstream pstream(s);
         SGFParser::parse(pstream, boardsize, komi, result, moves);
 
-        if (boardsize != 19)
+        if (boardsize != zero::board_size)
             continue;
             
         if (moves.size() < 0)
@@ -310,7 +310,7 @@ int GameArchive::load(const std::string& path, bool append) {
 
     follow_distribution_ = false;
     if (type == 'P')
-        follow_distribution_ = true; // every move followed by 362 move probs
+        follow_distribution_ = true; // every move followed by board_moves move probs
     
     while (true) {
         char c;
@@ -342,8 +342,8 @@ int GameArchive::load(const std::string& path, bool append) {
             }  
 
             if (follow_distribution_) {
-                std::array<float, 362> dist;
-                if (ifs.read((char*)&dist[0], 362*sizeof(float)).gcount() != 362*sizeof(float))
+                std::array<float, zero::board_moves> dist;
+                if (ifs.read((char*)&dist[0], sizeof(dist)).gcount() != sizeof(dist))
                     throw std::runtime_error("uncomplate move data (read disttribution)");
                 game.dists.emplace_back(dist);
             }
@@ -424,13 +424,13 @@ void GameArchive::extract_move(const int index, MoveData& out) {
         auto sign_pos = game_seq[i++];
         auto pos = std::abs(sign_pos) - 1;
 
-        if (pos > 361)
+        if (pos > zero::board_count)
             throw std::runtime_error("bad move pos " + std::to_string(pos));
 
         auto& my_board = black_player ? blacks : whites;
         auto& op_board = black_player ? whites : blacks;
 
-        if (pos == 361) {
+        if (pos == zero::board_count) {
             // pass
         } else {
             my_board[pos] = true;
@@ -440,7 +440,7 @@ void GameArchive::extract_move(const int index, MoveData& out) {
                 for (int n=0; n<rm; n++) {
                     auto rmpos = game_seq[i++];
                     
-                    if (rmpos < 0 || rmpos >= 361)
+                    if (rmpos < 0 || rmpos >= zero::board_count)
                         throw std::runtime_error("bad rm move pos " + std::to_string(rmpos));
                     op_board[rmpos] = false;
                 }
@@ -459,7 +459,7 @@ void GameArchive::extract_move(const int index, MoveData& out) {
     }
 
 
-    out.probs.resize(362, 0);
+    out.probs.resize(zero::board_moves, 0);
 
     if (follow_distribution_) {
         std::copy(game.dists[steps].begin(), game.dists[steps].end(), out.probs.begin());
@@ -7,7 +7,7 @@
 using std::vector;
 
 
-using BoardPlane = std::bitset<361>;
+using BoardPlane = std::bitset<zero::board_count>;
 using InputFeature = std::vector<BoardPlane>;
 
 struct MoveData {
@@ -19,7 +19,7 @@ struct MoveData {
 class GameArchive {
     struct game_t {
         vector<short> seqs;
-        std::vector<std::array<float, 362>> dists;
+        std::vector<std::array<float, zero::board_moves>> dists;
         int result;
     };
     vector<game_t> games_;
@@ -30,7 +30,7 @@ class GameArchive {
 
 public:
     int data_index;
-    const int boardsize = 19;
+    const int boardsize = zero::board_size;
 
     static void generate(const std::string& path, const std::string& out_path, int random_drop);
 
@@ -1,4 +1,5 @@
 #include "sgf.hpp"
+#include "../leela/size_info.h"
 #include <iostream>
 #include <fstream>
 #include <cassert>
@@ -10,11 +11,11 @@ inline bool is7bit(int c) {
 static int string_to_move(const std::string& movestring, int bsize) {
 
     if (movestring.size() == 0) {
-        return 361;
+        return bsize * bsize;
     }
 
     if (movestring == "tt") {
-        return 361;
+        return bsize * bsize;
     }
 
     char c1 = movestring[0];
@@ -72,7 +73,7 @@ std::vector<int> seq_to_moves(const std::string& seqs) {
             break;
 
         auto n = close_pos - i;
-        auto pos = string_to_move(seqs.substr(i, n), 19);
+        auto pos = string_to_move(seqs.substr(i, n), zero::board_size);
         i += n+1;
 
         if (next_player == 'B') next_player = 'W';
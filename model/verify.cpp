@@ -55,7 +55,7 @@ void verify(
             auto output = model.predict(d.input);
 
             int move = max_index(d.probs);
-            int predit_move = max_index(output.first.begin(), output.first.begin()+361);
+            int predit_move = max_index(output.first.begin(), output.first.begin()+zero::board_count);
 
            // if (move == 300)
             //    std::cout << predit_move << std::endl;
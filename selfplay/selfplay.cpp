@@ -3,6 +3,7 @@
 
 #include "nblapp/parameter.hpp"
 #include "leela/Leela.h"
+#include "leela/GTP.h"
 #include "leela/UCTSearch.h"
 #include "model/zero_model.hpp"
 #include "model/utils.hpp"
@@ -29,7 +30,8 @@ void train(
     int game_rounds,
     int train_rounds,
     int playouts,
-    int clean_per_rounds) {
+    int clean_per_rounds,
+    bool ponder) {
 
     GoBoard::init_board();
 
@@ -57,6 +59,8 @@ void train(
     solver.set_parameters(ParameterScope::get_parameters());
 
     auto eng = std::make_shared<Leela>(init_weight_path);
+    // After the engine has set up its defaults.
+    cfg_allow_pondering = ponder;
 
     float avg_loss = -1;
 
@@ -141,6 +145,7 @@ static int opt_games = 100;
 static int opt_trains = 30;
 static int opt_playouts = 1600;
 static int opt_clean_per_rounds = 100;
+static bool opt_ponder = true;
 
 void parse_commandline( int argc, char **argv ) {
     for (int i = 1; i < argc; i++) { 
@@ -164,6 +169,8 @@ void parse_commandline( int argc, char **argv ) {
             opt_playouts = atoi(argv[++i]);
         } else if (opt == "--group") {
             opt_clean_per_rounds = atoi(argv[++i]);
+        } else if (opt == "--noponder") {
+            opt_ponder = false;
         }
     }
 }
@@ -172,7 +179,7 @@ int main(int argc, char **argv) {
     parse_commandline(argc, argv);
     if (opt_init_weight.empty())
         opt_init_weight = opt_weights;
-    train(opt_weights, opt_init_weight, opt_batch_size, opt_learning_rate, opt_games, opt_trains, opt_playouts, opt_clean_per_rounds);
+    train(opt_weights, opt_init_weight, opt_batch_size, opt_learning_rate, opt_games, opt_trains, opt_playouts, opt_clean_per_rounds, opt_ponder);
     return 0;
 }
 
@@ -835,7 +835,7 @@ void go_window::scale_res() {
 
     auto_mutex M(wm);
 
-    long wood_size = radius*2 * 19 + edge_size*2;
+    long wood_size = radius*2 * zero::board_size + edge_size*2;
     img_wood.set_size(wood_size, wood_size);
     resize_image(img_wood_src, img_wood);
 
@@ -858,17 +858,17 @@ void go_window::paint(const canvas& c) {
 
 void go_window::draw_grid(const canvas& c) {
 
-    long len = radius*2*18;
+    long len = radius*2*(zero::board_size - 1);
     long start = radius+edge_size;
 
     long y = start;
-    for (int i=0; i<19; i++, y+= radius*2) {
+    for (int i=0; i<zero::board_size; i++, y+= radius*2) {
 
         draw_line (c, point(start, y), point(start + len, y), rgb_alpha_pixel(0, 0, 0, 100));
     }
 
     long x = start;
-    for (int i=0; i<19; i++, x+= radius*2) {
+    for (int i=0; i<zero::board_size; i++, x+= radius*2) {
         
         draw_line (c, point(x, start), point(x, start + len), rgb_alpha_pixel(0, 0, 0, 100));
     }
@@ -880,22 +880,20 @@ void go_window::draw_grid(const canvas& c) {
     draw_line (c, point(start + len + 1, start-1), point(start + len + 1, start + len + 1), rgb_alpha_pixel(0, 0, 0, 100));
 
     //  star
-    draw_solid_circle(c, loc(3,3), 3, rgb_alpha_pixel(0, 0, 0, 100));
-    draw_solid_circle(c, loc(3,9), 3, rgb_alpha_pixel(0, 0, 0, 100));
-    draw_solid_circle(c, loc(3,15), 3, rgb_alpha_pixel(0, 0, 0, 100));
-    draw_solid_circle(c, loc(9,3), 3, rgb_alpha_pixel(0, 0, 0, 100));
-    draw_solid_circle(c, loc(9,9), 3, rgb_alpha_pixel(0, 0, 0, 100));
-    draw_solid_circle(c, loc(9,15), 3, rgb_alpha_pixel(0, 0, 0, 100));
-    draw_solid_circle(c, loc(15,3), 3, rgb_alpha_pixel(0, 0, 0, 100));
-    draw_solid_circle(c, loc(15,9), 3, rgb_alpha_pixel(0, 0, 0, 100));
-    draw_solid_circle(c, loc(15,15), 3, rgb_alpha_pixel(0, 0, 0, 100));
+    const int edge = zero::board_size >= 13 ? 3 : 2;
+    const int stars[] = {edge, zero::board_size / 2, zero::board_size - 1 - edge};
+    for (auto sx : stars) {
+        for (auto sy : stars) {
+            draw_solid_circle(c, loc(sx,sy), 3, rgb_alpha_pixel(0, 0, 0, 100));
+        }
+    }
 }
 
 void go_window::draw_stones(const canvas& c) {
 
     int pos = 0;
-    for (int y=0; y<19; y++) {
-        for (int x=0; x<19; x++, pos++) {
+    for (int y=0; y<zero::board_size; y++) {
+        for (int x=0; x<zero::board_size; x++, pos++) {
             if (board[pos] != 0) {
                 int mark = (last_xy == pos) ? 1 : 0;
                 if (board[pos] == 1)
@@ -914,7 +912,7 @@ void go_window::on_window_resized() {
     get_size(width,height);
 
     auto length = std::min(width, height);
-    auto new_radius = (length - edge_size*2) / (19*2);
+    auto new_radius = (length - edge_size*2) / (zero::board_size*2);
 
     if (new_radius != radius && new_radius > 10) {
         radius = new_radius;
@@ -936,7 +934,7 @@ void go_window::draw_stone(const canvas& c, long x, long y, int black, int mark)
 void go_window::update(int move, int _board[]) {
 
     last_xy = move;
-    for (int i=0; i<361; i++)
+    for (int i=0; i<zero::board_count; i++)
         board[i] = _board[i];
     invalidate_rectangle(get_rect(img_wood));
 }
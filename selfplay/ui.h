@@ -2,6 +2,7 @@
 
 #include "gui_core.h"
 #include "array2d.h"
+#include "leela/size_info.h"
 
 using namespace std;
 using namespace dlib;
@@ -43,6 +44,6 @@ private:
     long radius = 16;
     long edge_size = 10;
 
-    int board[361];
+    int board[zero::board_count];
     int last_xy;
 };